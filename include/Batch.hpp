@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstddef>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "NumberFormat.hpp"
+#include "Parser.hpp"
+
+// Writes every result of parser to out, one line each, and keeps _ and ans
+// up to date
+void print_results(Parser& parser, OutputBuffer& out);
+
+// Evaluates every line of in without prompts, as a pipeline of three stages
+// connected by bounded queues: a reader thread splits the input into chunks of
+// lines, the calling thread evaluates them and a writer thread formats the
+// results to out, one line each. Errors go to err, one line each, in order with
+// the results, and do not stop the batch. The result handlers of parser are
+// reset afterwards.
+void run_batch(Parser& parser, std::istream& in, OutputBuffer& out, std::ostream& err);
+
+// Evaluates every file in a session of its own (symbol table, parser and output)
+// on a pool of `jobs` threads. The output of the files is written to out in
+// argument order. An error ends its file and goes to err as "path: message",
+// the other files continue. Returns the number of files that failed.
+std::size_t run_files(const std::vector<std::string>& paths, unsigned jobs, OutputBuffer& out, std::ostream& err);
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+#include "ListExpr.hpp"
+#include "types.hpp"
+
+// Throws unless a function of arity (-1 for one or more) accepts n arguments
+inline void check_arity(std::string_view name, int arity, std::size_t n)
+{
+    if (arity < 0 ? n > 0 : n == static_cast<std::size_t>(arity))
+        return;
+    if (!n)
+        throw std::runtime_error{ "Invalid empty argument list" };
+    throw std::runtime_error{ std::string{ name } + " expects " + std::to_string(arity)
+                              + (arity == 1 ? " argument" : " arguments") + " (received "
+                              + std::to_string(n) + ")" };
+}
+
+// A built-in function with its true arity. Arguments are passed as an array,
+// usually a slice of the parser's evaluation stack, so a call allocates nothing.
+class Builtin {
+public:
+    using Unary = Complex(*)(const Complex& x);
+    using Binary = Complex(*)(const Complex& x, const Complex& y);
+    using Variadic = Complex(*)(const Complex* args, std::size_t n);
+
+    static constexpr int variadic{ -1 };
+
+    constexpr Builtin() noexcept = default;
+    constexpr Builtin(Unary f, ElementFunc elements) noexcept
+        : numArgs{ 1 }, unary{ f }, elements{ elements } { }
+    constexpr Builtin(Binary f) noexcept
+        : numArgs{ 2 }, binary{ f } { }
+    constexpr Builtin(Variadic f) noexcept
+        : numArgs{ variadic }, many{ f } { }
+
+    constexpr int arity() const noexcept { return numArgs; }
+    constexpr bool accepts(std::size_t n) const noexcept
+    {
+        return numArgs == variadic ? n > 0 : n == static_cast<std::size_t>(numArgs);
+    }
+
+    // Throws unless n arguments are accepted
+    void check_arity(std::string_view name, std::size_t n) const { ::check_arity(name, numArgs, n); }
+
+    // The function of every element of a block, nullptr unless unary
+    constexpr ElementFunc element_func() const noexcept { return elements; }
+
+    // n has to be accepted
+    Complex operator()(const Complex* args, std::size_t n) const
+    {
+        switch (numArgs) {
+        case 1:
+            return unary(args[0]);
+        case 2:
+            return binary(args[0], args[1]);
+        default:
+            return many(args, n);
+        }
+    }
+
+private:
+    int numArgs{};
+    Unary unary{};
+    Binary binary{};
+    Variadic many{};
+    ElementFunc elements{};
+};
@@ -1,9 +1,12 @@
 #pragma once
 
 #include <functional>
+#include <istream>
 #include <map>
 #include <string>
+#include <vector>
 
+#include "NumberFormat.hpp"
 #include "Parser.hpp"
 #include "SymbolTable.hpp"
 
@@ -15,8 +18,11 @@ public:
 private:
     bool handle_cmd(const std::string& cmd);
     void register_commands();
+    void register_result_handlers();
 
     bool run_file(const std::string& path);
+    void run_files(const std::vector<std::string>& paths, unsigned jobs);
+    void run_batch(std::istream& is);
     void run_cli();
 
     SymbolTable symbolTable;
@@ -24,4 +30,6 @@ private:
     std::string prompt{ "> " };
     std::string intro;
     std::map<std::string, std::function<void()>> commands;
+    std::map<std::string, std::function<void(const std::string&)>> paramCommands;
+    OutputBuffer out{ std::cout };
 };
\ No newline at end of file
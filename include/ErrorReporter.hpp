@@ -1,33 +1,25 @@
 #pragma once
 
-#include <functional>
 #include <stdexcept>
 #include <sstream>
-#include <utility>
 
 class ErrorReporter {
 public:
-    template<class T, class ...Args>
-    void operator()(const T& t, Args&&... args)
-    {
-        error(t, std::forward<Args>(args)...);
+    template<class ...Args>
+    [[noreturn]] void operator()(const Args&... args) const
+    {   // the message is only assembled once something actually went wrong
+        std::ostringstream msg;
+        append(msg, args...);
+        throw std::runtime_error{ msg.str() };
     }
 
 private:
     template<class T, class ...Args>
-    void error(const T& t, Args&&... args)
-    {
-        msgStream << t;
-        error(std::forward<Args>(args)...);
-    }
-
-    void error()
+    static void append(std::ostream& os, const T& t, const Args&... args)
     {
-        auto msg = msgStream.str();
-        msgStream.str("");
-        msgStream.clear();
-        throw std::runtime_error{ msg };
+        os << t;
+        append(os, args...);
     }
 
-    std::ostringstream msgStream;
+    static void append(std::ostream&) { }
 };
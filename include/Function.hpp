@@ -18,6 +18,8 @@ public:
 
     std::size_t numArgs() const noexcept { return vars.size(); }
     const std::string& name() const { return funcName; }
+    const std::string& get_term() const { return term; }
+    const std::vector<std::string>& get_vars() const { return vars; }
 
     friend std::ostream& operator<<(std::ostream& os, const Function& func);
 
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstddef>
+
+#include "ListSource.hpp"
+#include "math_util.hpp"
+#include "types.hpp"
+
+// Equal-width bins over [low, high]; the last bin includes high
+struct Bins {
+    double low;
+    double high;
+    std::size_t count;
+};
+
+enum class BinStat {
+    Count,  // elements per bin
+    Sum,    // sum of the elements per bin
+    Mean    // their mean, nan for empty bins
+};
+
+// Bins spanning the smallest to the largest element
+Bins data_bins(ListSource list, std::size_t count);
+// Bins from the arguments of hist and friends: count[, low, high]
+Bins make_bins(ListSource list, const List& params);
+List bin_centers(const Bins& bins);
+
+// One statistic per bin of a real list in a single pass; elements outside the
+// bins and nan are ignored. Long lists are split into ranges that each fill a
+// partial histogram, on all threads for stored lists. How they are cut and added
+// up does not depend on the thread count, so neither do the bin sums.
+List binned(ListSource list, const Bins& bins, BinStat stat, const ReduceOptions& opts = {});
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <string>
+
+#include "types.hpp"
+
+// Bulk import of measurement data into lists, bypassing the parser. Files are
+// memory-mapped; CSV text is split into chunks of whole lines that are parsed
+// with from_chars on all cores.
+
+// Reads the given 1-based column of a comma, semicolon or tab separated file.
+// A first line whose field is not a number is skipped as the header.
+List import_csv(const std::string& path, std::size_t column = 1);
+
+// Reads a file of raw little-endian doubles
+List import_binary(const std::string& path);
+
+// import_binary for *.bin files, import_csv otherwise
+List import_list(const std::string& path, std::size_t column = 1);
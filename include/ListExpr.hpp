@@ -0,0 +1,137 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include "ListSource.hpp"
+#include "ListView.hpp"
+#include "types.hpp"
+
+// Element-wise list arithmetic. Operators on lists build a tree of ListExpr
+// nodes instead of computing anything; the tree is evaluated block by block at
+// the end, so a*b + c runs in one pass over the data without list temporaries.
+class ListExpr {
+public:
+    static constexpr std::size_t blockSize{ 128 };
+
+    explicit ListExpr(std::size_t size) noexcept
+        : length{ size } { }
+    virtual ~ListExpr() = default;
+
+    std::size_t size() const noexcept { return length; }
+
+    // Elements [first, first + n), n <= blockSize. Returns scratch filled with
+    // them, or a pointer to where they are already stored.
+    virtual const Complex* eval(std::size_t first, std::size_t n, Complex* scratch) const = 0;
+
+    // All elements if they are stored contiguously, nullptr otherwise
+    virtual const Complex* data() const noexcept { return nullptr; }
+
+    // Whether evaluating reads any element of list
+    virtual bool reads_from(ListView) const noexcept { return false; }
+
+    // Known to be in ascending order, like the result of sort
+    virtual bool is_sorted() const noexcept { return false; }
+
+private:
+    std::size_t length;
+};
+
+using ListExprPtr = std::shared_ptr<const ListExpr>;
+
+// Result of an expression: a number, a list expression or a matrix
+class Value {
+public:
+    Value(Complex num = {}) noexcept
+        : number{ num } { }
+    Value(double num) noexcept
+        : number{ num } { }
+    Value(ListExprPtr list) noexcept
+        : expr{ std::move(list) } { }
+    Value(MatrixPtr matrix) noexcept
+        : mat{ std::move(matrix) } { }
+    Value(Matrix matrix)
+        : mat{ std::make_shared<const Matrix>(std::move(matrix)) } { }
+
+    bool is_list() const noexcept { return expr != nullptr; }
+    bool is_matrix() const noexcept { return mat != nullptr; }
+    const Complex& num() const noexcept { return number; }
+    const ListExprPtr& list() const noexcept { return expr; }
+    const MatrixPtr& matrix() const noexcept { return mat; }
+
+private:
+    Complex number;
+    ListExprPtr expr;
+    MatrixPtr mat;
+};
+
+enum class ElemOp {
+    Add, Sub, Mul, Div, FloorDiv, Mod, Parallel, Pow,
+    LiteralPow  // exponent written as a literal, see literal_pow
+};
+
+enum class UnaryOp {
+    Neg, Fac
+};
+
+// Numbers give numbers, as soon as one operand is a list the result is a list
+// expression. A number is applied to every element, two lists need the same length.
+// Matrices are added, multiplied (also by a list as column vector), scaled,
+// negated and raised to integer powers.
+Complex apply(ElemOp op, const Complex& left, const Complex& right);
+Value apply(ElemOp op, const Value& left, const Value& right);
+Value apply(UnaryOp op, const Value& operand);
+
+// Built-in applied to the n elements of a block, out may be in
+using ElementFunc = void(*)(const Complex* in, Complex* out, std::size_t n);
+// f of every element, evaluated block by block like the operators
+Value map_elements(ElementFunc f, const ListExprPtr& list);
+
+// Function of several arguments over blocks, e.g. one loaded from a plugin
+class BlockFunction {
+public:
+    virtual ~BlockFunction() = default;
+    // out[i] = f(args[0][i], ..., args[nargs - 1][i]) for i < n, out never overlaps args
+    virtual void eval(const Complex* const* args, std::size_t nargs, Complex* out, std::size_t n) const = 0;
+};
+
+// f of the elements at the same position in all lists among args, which need
+// the same length; numbers stand in for every element
+Value map_elements(std::shared_ptr<const BlockFunction> f, const std::vector<Value>& args);
+
+// A list expression referring to view, which has to outlive it
+Value list_value(ListView view, bool sorted = false);
+// A list expression sharing ownership of the elements of view, e.g. with a stored list
+Value list_value(ListView view, std::shared_ptr<const void> owner, bool sorted = false);
+Value list_value(List&& list, bool sorted = false);  // takes over a list that is about to be discarded
+
+// count elements of list, starting at first and step apart. A contiguous slice
+// of stored data is a view of it, nothing is copied.
+Value slice(const ListExprPtr& list, std::size_t first, std::ptrdiff_t step, std::size_t count);
+Complex element(const ListExpr& list, std::size_t i);
+
+List to_list(const ListExpr& expr);
+void eval_to(const ListExpr& expr, Complex* out);  // writes all elements to out
+
+struct ReduceOptions;
+
+// Built-in taking a list followed by numbers, returning a number or a list
+using ListFunc = Value(*)(ListSource list, const List& params, const ReduceOptions& opts);
+// Built-in taking any values, e.g. matrices
+using ValueFunc = Value(*)(const std::vector<Value>& args);
+
+// Reads a list expression block by block, e.g. into a reduction
+class ListExprStream : public ListStream {
+public:
+    explicit ListExprStream(ListExprPtr expr) noexcept
+        : expr{ std::move(expr) } { }
+
+    std::size_t size() const override { return expr->size(); }
+    void restart() override { pos = 0; }
+    std::size_t read(Complex* out, std::size_t max) override;
+
+private:
+    ListExprPtr expr;
+    std::size_t pos{};
+};
@@ -0,0 +1,27 @@
+#pragma once
+
+#include "Function.hpp"
+#include "ListSource.hpp"
+#include "types.hpp"
+
+// The list [for var=start, end:step term], evaluated lazily. Elements are the
+// term at start, start + step, ... while not beyond end, with the loop variable
+// accumulated exactly like the eager loop, so both yield the same values.
+class ListRange : public ListStream {
+public:
+    ListRange(double start, double end, double step, Function term);
+
+    std::size_t size() const override { return count; }
+    void restart() override;
+    std::size_t read(Complex* out, std::size_t max) override;
+
+    List to_list();
+
+private:
+    double start;
+    double step;
+    Function term;
+    std::size_t count{};
+    double next{};
+    std::size_t pos{};
+};
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstddef>
+
+#include "ListView.hpp"
+#include "types.hpp"
+
+// Elements of a list produced in order, block by block, so the whole list never
+// has to exist in memory. A stream can be restarted to read it again.
+class ListStream {
+public:
+    virtual ~ListStream() = default;
+
+    virtual std::size_t size() const = 0;
+    virtual void restart() = 0;
+    // Writes the next elements to out, filling all max places unless the end is
+    // reached first. Returns the number written, 0 at the end.
+    virtual std::size_t read(Complex* out, std::size_t max) = 0;
+};
+
+// Input of a list reduction: stored elements or a stream
+class ListSource {
+public:
+    ListSource(ListView view, bool sorted = false) noexcept
+        : elements{ view }, sorted{ sorted } { }
+    ListSource(const List& list) noexcept
+        : elements{ list } { }
+    ListSource(ListStream& stream, bool sorted = false) noexcept
+        : stream{ &stream }, sorted{ sorted } { }
+
+    std::size_t size() const { return stream ? stream->size() : elements.size(); }
+
+    // nullptr if the source is stored, then view() holds the elements
+    ListStream* as_stream() const noexcept { return stream; }
+    ListView view() const noexcept { return elements; }
+
+    // Known to be in ascending order of the real parts, see sorted()
+    bool is_sorted() const noexcept { return sorted; }
+
+private:
+    ListView elements;
+    ListStream* stream{};
+    bool sorted{};
+};
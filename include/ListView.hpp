@@ -0,0 +1,47 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+
+#include "types.hpp"
+
+// Non-owning, read-only view of contiguous list data, which may live in a List
+// or in a mapped file. Cheap to copy, pass it by value.
+class ListView {
+public:
+    using value_type = Complex;
+    using const_iterator = const Complex*;
+
+    constexpr ListView() noexcept = default;
+    constexpr ListView(const Complex* data, std::size_t size) noexcept
+        : first{ data }, length{ size } { }
+    ListView(const List& list) noexcept
+        : first{ list.data() }, length{ list.size() } { }
+
+    constexpr const Complex* data() const noexcept { return first; }
+    constexpr std::size_t size() const noexcept { return length; }
+    constexpr bool empty() const noexcept { return !length; }
+
+    constexpr const_iterator begin() const noexcept { return first; }
+    constexpr const_iterator end() const noexcept { return first + length; }
+
+    constexpr const Complex& operator[](std::size_t i) const noexcept { return first[i]; }
+    constexpr const Complex& front() const noexcept { return first[0]; }
+    constexpr const Complex& back() const noexcept { return first[length - 1]; }
+
+    List to_list() const { return { begin(), end() }; }
+
+private:
+    const Complex* first{};
+    std::size_t length{};
+};
+
+inline bool operator==(ListView left, ListView right)
+{
+    return std::equal(left.begin(), left.end(), right.begin(), right.end());
+}
+
+inline bool operator!=(ListView left, ListView right)
+{
+    return !(left == right);
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+enum class MapMode {
+    ReadOnly,
+    CopyOnWrite  // writable, changes stay private to the process and never reach the file
+};
+
+// View of a whole file mapped into memory. The OS page cache backs the data, so
+// nothing is copied until it is actually touched.
+class MappedFile {
+public:
+    MappedFile() = default;
+    explicit MappedFile(const std::string& path, MapMode mode = MapMode::ReadOnly);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    const char* data() const noexcept { return first; }
+    std::size_t size() const noexcept { return length; }
+    char* mutable_data() const noexcept { return writable ? first : nullptr; }  // copy-on-write mappings only
+
+private:
+    void unmap() noexcept;
+
+    char* first{};
+    std::size_t length{};
+    bool writable{};
+};
+
+// Raw numeric files are little-endian; true if they can be used without byte swapping
+inline bool host_is_little_endian() noexcept
+{
+    const std::uint16_t one{ 1 };
+    unsigned char low;
+    std::memcpy(&low, &one, 1);
+    return low == 1;
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <ostream>
+#include <string>
+
+#include "ListView.hpp"
+#include "types.hpp"
+
+// Precision used by std::ostream unless told otherwise, 0 selects shortest round-trip output
+constexpr int defaultPrecision{ 6 };
+
+void format_real(std::string& out, double num, int precision = defaultPrecision);
+void format_complex(std::string& out, const Complex& num, int precision = defaultPrecision);
+void format_list(std::string& out, ListView list, int precision = defaultPrecision);
+void format_matrix(std::string& out, const Matrix& matrix, int precision = defaultPrecision);
+
+class OutputBuffer {
+public:
+    explicit OutputBuffer(std::ostream& os, std::size_t capacity = 1 << 16);
+    ~OutputBuffer();
+
+    OutputBuffer(const OutputBuffer&) = delete;
+    OutputBuffer& operator=(const OutputBuffer&) = delete;
+
+    void write(const Complex& num);
+    void write(ListView list);
+    void write(const Matrix& matrix);
+    void write(const std::string& str);
+    void write(char ch);
+
+    void flush();
+
+    void set_precision(int digits) { precision = digits; }
+    int get_precision() const { return precision; }
+
+private:
+    void flush_if_full();
+
+    std::ostream& os;
+    std::string buf;
+    std::size_t capacity;
+    int precision{ defaultPrecision };
+};
@@ -0,0 +1,19 @@
+#pragma once
+
+#include "ListSource.hpp"
+#include "math_util.hpp"
+#include "types.hpp"
+
+// Order statistics of real lists; complex elements and nan have no order and
+// are rejected. A source known to be sorted is answered by indexing, anything else
+// is copied once and partially ordered with std::nth_element in linear time.
+
+Complex list_min(ListSource list, const ReduceOptions& opts = {});
+Complex list_max(ListSource list, const ReduceOptions& opts = {});
+Complex median(ListSource list, const ReduceOptions& opts = {});
+// Interpolates linearly between the closest ranks, p in [0, 100]
+Complex percentile(ListSource list, double p, const ReduceOptions& opts = {});
+
+// Ascending copy. Lists above the parallel threshold are sorted in chunks on
+// all threads, which are then merged pairwise.
+List sorted(ListSource list, const ReduceOptions& opts = {});
@@ -1,11 +1,19 @@
 #pragma once
 
+#include <cstddef>
 #include <istream>
 #include <map>
 #include <string>
+#include <vector>
 
+#include "Builtin.hpp"
 #include "ErrorReporter.hpp"
 #include "Function.hpp"
+#include "ListExpr.hpp"
+#include "ListRange.hpp"
+#include "ListView.hpp"
+#include "math_util.hpp"
+#include "Plugin.hpp"
 #include "TokenStream.hpp"
 #include "types.hpp"
 
@@ -17,6 +25,8 @@ public:
 
     void parse(std::istream& is);
     void parse(const std::string& input);
+    // Evaluates an expression and appends the number or the list elements to a stored list
+    void append(const std::string& list, const std::string& input);
 
     const Complex& result() const { return res; }
     bool has_result() const { return hasResult; }
@@ -26,6 +36,8 @@ public:
 
     void set_vardef_is_res(bool isRes) { varDefIsRes = isRes; }
     void on_result(std::function<void(Complex)> handler) { onRes = std::move(handler); }
+    void on_list_result(std::function<void(ListView)> handler) { onListRes = std::move(handler); }
+    void on_matrix_result(std::function<void(const Matrix&)> handler) { onMatrixRes = std::move(handler); }
 
 private:
     void parse();
@@ -35,20 +47,33 @@ private:
     void parse_func_term(Function& func);
     void deletion();
     void del_symbol();
-    void list_def(const std::string& name);
-
-    Complex expr();
-    Complex term();
-    Complex sign();
-    Complex postfix();
-    Complex prim();
-    Complex resolve_str_tok();
-    Complex var_def(const std::string& name);
+    void list_result(const ListExpr& list);
+    void print_list_result(ListView list);
+    void matrix_result(const Matrix& matrix);
+
+    Value expr();
+    Value term();
+    Value sign();
+    Value postfix();
+    bool literal_exponent();
+    Value prim();
+    Value subscript(const Value& val);
+    std::ptrdiff_t index();
+    Value resolve_str_tok();
+    Value var_def(const std::string& name);
+    Value builtin(const std::string& name, const Builtin& f);
+    Value native(const std::shared_ptr<const NativeFunction>& f);
+    Complex reduction(Reduction r, bool allowEmpty);
+    Value list_func(ListFunc f);
     Complex no_result();
 
-    List list();
+    Value list();
+    ListRange list_range();
     List arg_list();
     List list_elem();
+    std::vector<Value> value_list();
+    List splice(const std::vector<Value>& values);
+    Complex number(const Value& val);
 
     const std::string& ident();
 
@@ -56,7 +81,6 @@ private:
     bool consume(Kind kind);
     void expect(Kind kind);
 
-    Token prevTok;
     SymbolTable& table;
     TokenStream ts;
     ErrorReporter error;
@@ -65,6 +89,9 @@ private:
     bool hasResult{};
     bool varDefIsRes{ true };
     std::function<void(Complex)> onRes;
+    std::function<void(ListView)> onListRes;
+    std::function<void(const Matrix&)> onMatrixRes;
+    std::vector<Complex> stack;  // arguments of built-in calls, keeps its capacity between calls
 };
 
 
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string>
+
+#include "deskcalc_plugin.h"
+#include "ListExpr.hpp"
+#include "types.hpp"
+
+class SymbolTable;
+
+// A shared library loaded at runtime, unloaded when the last function from it is gone
+class PluginLibrary {
+public:
+    explicit PluginLibrary(const std::string& path);
+    ~PluginLibrary();
+
+    PluginLibrary(const PluginLibrary&) = delete;
+    PluginLibrary& operator=(const PluginLibrary&) = delete;
+
+    void* symbol(const char* name) const noexcept;  // nullptr if not exported
+    const std::string& path() const noexcept { return file; }
+
+private:
+    std::string file;
+    void* handle{};
+};
+
+// Function registered by a plugin. Lists are passed to its batch entry point
+// block by block; without one the scalar entry point is called per element.
+class NativeFunction : public BlockFunction {
+public:
+    NativeFunction(const dc_function& f, std::shared_ptr<const PluginLibrary> library);
+
+    const std::string& name() const noexcept { return funcName; }
+    int arity() const noexcept { return numArgs; }
+    bool is_pure() const noexcept { return pure; }
+    const std::string& library() const noexcept { return lib->path(); }
+
+    void check_arity(std::size_t n) const;
+    Complex operator()(const Complex* args, std::size_t n) const;
+    void eval(const Complex* const* args, std::size_t nargs, Complex* out, std::size_t n) const override;
+
+private:
+    void check(int rc) const;
+
+    std::string funcName;
+    int numArgs;
+    bool pure;
+    dc_scalar_fn scalar;
+    dc_batch_fn batch;
+    std::shared_ptr<const PluginLibrary> lib;
+};
+
+// Loads a plugin and adds its functions to table, replacing those of the same
+// name from earlier plugins. Returns the number of functions; nothing is added
+// if initializing the plugin or registering any of them fails.
+std::size_t load_plugin(SymbolTable& table, const std::string& path);
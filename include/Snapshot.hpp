@@ -0,0 +1,11 @@
+#pragma once
+
+#include <string>
+
+class SymbolTable;
+
+// Binary session snapshots. A snapshot holds every variable (with its access),
+// list, matrix and user-defined function of a SymbolTable. Loading maps the file and
+// copies list data in bulk, nothing goes through the parser.
+void save_snapshot(const SymbolTable& table, const std::string& path);
+void load_snapshot(SymbolTable& table, const std::string& path);
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <stdexcept>
+#include <string_view>
+#include <utility>
+
+// Read-only map from string_view keys to values, built with a perfect hash at
+// compile time. The constructor searches for a seed that gives every key its
+// own slot, so a lookup is one hash, one table access and one string compare,
+// and a constexpr instance needs no initialization at runtime.
+template<class T, std::size_t N>
+class StaticStrMap {
+public:
+    using value_type = std::pair<std::string_view, T>;
+
+    constexpr explicit StaticStrMap(const value_type (&init)[N])
+    {
+        for (std::size_t i = 0; i < N; ++i) {
+            keys[i] = init[i].first;
+            values[i] = init[i].second;
+        }
+
+        for (seed = 0; seed < maxSeed; ++seed) {
+            if (fill_slots())
+                return;
+        }
+        throw std::logic_error{ "StaticStrMap: no perfect hash seed found" };
+    }
+
+    constexpr const T* find(std::string_view key) const noexcept
+    {
+        const auto slot = slots[hash(key, seed) & (tableSize - 1)];
+        if (slot && keys[slot - 1] == key)
+            return &values[slot - 1];
+        return nullptr;
+    }
+
+    constexpr bool contains(std::string_view key) const noexcept { return find(key) != nullptr; }
+
+private:
+    static_assert(N < 255, "StaticStrMap stores slot indices as bytes");
+
+    static constexpr std::size_t ceil_pow2(std::size_t n)
+    {
+        std::size_t p{ 1 };
+        while (p < n)
+            p *= 2;
+        return p;
+    }
+
+    static constexpr std::uint32_t hash(std::string_view key, std::uint32_t seed) noexcept
+    {   // FNV-1a with the seed folded into the offset basis
+        std::uint32_t h{ 2166136261u ^ seed };
+        for (const char c : key) {
+            h ^= static_cast<unsigned char>(c);
+            h *= 16777619u;
+        }
+        return h ^ (h >> 15);
+    }
+
+    constexpr bool fill_slots()
+    {
+        for (auto& slot : slots)
+            slot = 0;
+        for (std::size_t i = 0; i < N; ++i) {
+            auto& slot = slots[hash(keys[i], seed) & (tableSize - 1)];
+            if (slot)
+                return false;
+            slot = static_cast<std::uint8_t>(i + 1);
+        }
+        return true;
+    }
+
+    static constexpr std::size_t tableSize{ ceil_pow2(8 * N) };
+    static constexpr std::uint32_t maxSeed{ 1u << 16 };
+
+    std::array<std::string_view, N> keys{};
+    std::array<T, N> values{};
+    std::array<std::uint8_t, tableSize> slots{};  // index + 1 into keys/values, 0 if empty
+    std::uint32_t seed{};
+};
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <memory>
+#include <string>
+
+#include "ListExpr.hpp"
+#include "ListView.hpp"
+#include "MappedFile.hpp"
+#include "types.hpp"
+
+// A named list, either held in memory or mapped from a file of raw complex
+// doubles (real and imaginary part, little-endian). Mapped lists are paged in
+// by the OS as they are read, so they may be larger than the available RAM.
+// Copies share the elements, like list expressions reading them; changes copy
+// them first while they are shared.
+class StoredList {
+public:
+    StoredList() = default;
+    StoredList(List values)
+        : values{ std::make_shared<List>(std::move(values)) } { }
+
+    static StoredList map(const std::string& path, MapMode mode = MapMode::ReadOnly);
+
+    ListView view() const noexcept;
+    bool is_mapped() const noexcept { return file != nullptr; }
+    bool is_sorted() const noexcept { return sorted; }  // set by assigning a sorted list
+    // Keeps the elements of view() alive, also after the list is changed
+    std::shared_ptr<const void> owner() const noexcept;
+
+    // Writable element data; read-only or shared mappings are copied into memory first
+    Complex* mutable_data();
+
+    // Replaces the elements, the list is unchanged if evaluating expr throws.
+    // The storage of the old ones is kept as spare for the next assign if it is
+    // small, so redefining a short list repeatedly does not allocate.
+    void assign(const ListExpr& expr);
+    // Appends the elements, growing the storage geometrically like push_back.
+    // A mapped list is copied into memory first.
+    void append(const ListExpr& expr);
+
+private:
+    bool is_shared() const noexcept { return values.use_count() > 1; }
+
+    std::shared_ptr<List> values;
+    List spare;  // storage for the next assign, only of short lists
+    std::shared_ptr<MappedFile> file;
+    bool sorted{};
+};
+
+// Writes list data in the format StoredList::map expects
+void write_raw_list(ListView list, const std::string& path);
@@ -1,12 +1,18 @@
 #pragma once
 
 #include <map>
+#include <memory>
 #include <string>
-#include <experimental/string_view>
+#include <string_view>
 
 #include "mps/stl_util.hpp"
 
+#include "Builtin.hpp"
 #include "Function.hpp"
+#include "ListView.hpp"
+#include "math_util.hpp"
+#include "Plugin.hpp"
+#include "StoredList.hpp"
 #include "types.hpp"
 
 enum class VarAccess {
@@ -26,7 +32,6 @@ struct Var {
 class SymbolTable {
 public:
     using ConstStrRef = const std::string&;
-    using FuncMap = std::map<std::string, Func>;
 
     SymbolTable();
 
@@ -35,20 +40,41 @@ public:
     void set_const(ConstStrRef name, Complex value);
     void set_var(ConstStrRef name, Complex value);
     void set_list(ConstStrRef name, List&& list);
+    void set_list(ConstStrRef name, const ListExpr& expr);
+    void append_list(ConstStrRef name, const ListExpr& expr);  // creates the list if needed
+    void set_matrix(ConstStrRef name, MatrixPtr matrix);
+    void map_list(ConstStrRef name, const std::string& path, MapMode mode = MapMode::ReadOnly);
     void set_func(ConstStrRef name, Function func);
+    void add_native(std::shared_ptr<const NativeFunction> func);  // replaces one of the same name
 
     Complex value_of(ConstStrRef var) const;
-    const List& list(ConstStrRef var) const;
+    ListView list(ConstStrRef var) const;
     Complex call_func(ConstStrRef func, const List& args) const;
 
+    // Non-throwing lookups for hot paths, nullptr if the symbol is undefined
+    const Var* find_var(ConstStrRef name) const noexcept;
+    const StoredList* find_list(ConstStrRef name) const noexcept;
+    MatrixPtr find_matrix(ConstStrRef name) const noexcept;
+    const Function* find_func(ConstStrRef name) const noexcept;
+    std::shared_ptr<const NativeFunction> find_native(ConstStrRef name) const noexcept;
+    static const Builtin* find_builtin(std::string_view name) noexcept;
+    static Reduction find_reduction(std::string_view name) noexcept;
+    static ListFunc find_list_func(std::string_view name) noexcept;
+    static ValueFunc find_value_func(std::string_view name) noexcept;
+
+    const ReduceOptions& reduce_options() const noexcept { return reduceOpts; }
+    void set_reduce_options(const ReduceOptions& opts) noexcept { reduceOpts = opts; }
+
     bool is_const(ConstStrRef name) const;
     bool has_var(ConstStrRef name) const;
     bool has_list(ConstStrRef name) const;
+    bool has_matrix(ConstStrRef name) const;
     bool has_func(ConstStrRef name) const;
     bool isset(ConstStrRef name) const;
 
     void remove_var(ConstStrRef name);
     void remove_list(ConstStrRef name);
+    void remove_matrix(ConstStrRef name);
     void remove_func(ConstStrRef name);
     void remove_symbol(ConstStrRef name);
 
@@ -56,19 +82,23 @@ public:
     void clear_vars();
     void clear_funcs();
     void clear_lists();
+    void clear_matrices();
 
     const std::map<std::string, Var>& vars() const { return varTable; }
-    const std::map<std::string, List>& lists() const { return listTable; }
+    const std::map<std::string, StoredList>& lists() const { return listTable; }
+    const std::map<std::string, MatrixPtr>& matrices() const { return matrixTable; }
     const std::map<std::string, Function>& funcs() const { return funcTable; }
+    const std::map<std::string, std::shared_ptr<const NativeFunction>>& natives() const { return nativeTable; }
 
 private:
     void add_constants();
 
-    static const FuncMap defaultFuncTable;
-
     std::map<std::string, Var> varTable;
-    std::map<std::string, List> listTable;
+    std::map<std::string, StoredList> listTable;
+    std::map<std::string, MatrixPtr> matrixTable;  // immutable, shared with the values using them
     std::map<std::string, Function> funcTable;
+    std::map<std::string, std::shared_ptr<const NativeFunction>> nativeTable;  // loaded from plugins, kept by clear
+    ReduceOptions reduceOpts;
 };
 
 Var make_const_var(Complex value);
@@ -37,6 +37,7 @@ struct Token {
     Kind kind{};
     std::string str;
     double num{};
+    std::size_t start{};  // offset of the first character in the input
 };
 
 inline std::ostream& operator<<(std::ostream& os, Kind kind)
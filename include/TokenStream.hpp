@@ -1,6 +1,9 @@
 #pragma once
 
+#include <array>
 #include <istream>
+#include <sstream>
+#include <string>
 
 #include "ErrorReporter.hpp"
 #include "Token.hpp"
@@ -21,17 +24,48 @@ public:
     void set_input(std::istream* input);
     void set_input(const std::string& input);
 
-    Token get();
-    const Token& current() const { return ct; }
+    const Token& get();
+    const Token& current() const { return ring[pos & mask]; }
+    const Token& previous() const { return ring[(pos - 1) & mask]; }
+    const Token& peek(std::size_t ahead);
+
+    static constexpr std::size_t capacity{ 16 };
+
+    // Source capture: end_capture() returns the input text from the start of the
+    // current token at start_capture() up to the start of the current token,
+    // exactly as written (numbers keep all their digits)
+    void start_capture();
+    std::string end_capture();
 
 private:
-    Token parse_identifier(char firstChar);
-    Token parse_double_op(char expected, Kind onSuccess, Kind onFailure);
-    Token identifier_to_token(const std::string& str) const;
+    void lex(Token& tok);
+    const Token& emit(Token& tok, Kind kind);
+    void parse_number(Token& tok, char firstChar);
+    void parse_identifier(Token& tok, char firstChar);
+    Kind parse_double_op(char expected, Kind onSuccess, Kind onFailure);
+    bool next_char(char& ch);
+    void put_back();
+    void trim_source();
     void cleanup();
 
-    Token ct{ Kind::End };
+    static_assert((capacity & (capacity - 1)) == 0, "capacity must be a power of two");
+    static constexpr std::size_t mask{ capacity - 1 };
+
+    // Ring of the most recently lexed tokens, indexed by absolute token number.
+    // Token 0 is the End token in place before the first get().
+    std::array<Token, capacity> ring{};
+    std::size_t pos{};      // number of the current token
+    std::size_t lexed{ 1 }; // number of tokens lexed so far
+
+    // Characters read so far, starting at offset sourceBase of the input
+    std::string source;
+    std::size_t sourceBase{};
+    std::size_t captureStart{};
+    bool capturing{};
+    bool canPutBack{};
+
     std::istream* input{};
+    std::istringstream strInput;  // reused by set_input(const std::string&)
     bool ownsInput{};
     ErrorReporter error;
 };
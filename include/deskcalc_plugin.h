@@ -0,0 +1,66 @@
+#ifndef DESKCALC_PLUGIN_H
+#define DESKCALC_PLUGIN_H
+
+/* C interface of native DeskCalc plugins. A plugin is a shared library
+ * (.so, .dylib or .dll) that exports deskcalc_plugin_init, which registers its
+ * functions through the host. After "plugin <file>" they are called like
+ * built-ins, e.g. model(x, y). Unlike built-ins, list arguments are not spliced
+ * into the argument list: the function is applied to the elements at the same
+ * position in every list, numbers standing in for every element. */
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define DESKCALC_PLUGIN_ABI_VERSION 2
+
+#ifdef _WIN32
+#define DESKCALC_EXPORT __declspec(dllexport)
+#else
+#define DESKCALC_EXPORT __attribute__((visibility("default")))
+#endif
+
+/* Same layout as std::complex<double> */
+typedef struct dc_complex {
+    double re;
+    double im;
+} dc_complex;
+
+/* result = f(args[0], ..., args[nargs - 1]), returns 0 on success and an error code otherwise */
+typedef int (*dc_scalar_fn)(const dc_complex* args, size_t nargs, dc_complex* result);
+
+/* results[i] = f(args[0][i], ..., args[nargs - 1][i]) for i < n, returns 0 on success.
+ * Called for blocks of list elements, results never overlaps args. */
+typedef int (*dc_batch_fn)(const dc_complex* const* args, size_t nargs, dc_complex* results, size_t n);
+
+#define DESKCALC_VARIADIC (-1)
+
+typedef struct dc_function {
+    size_t struct_size;   /* sizeof(dc_function) the plugin was built with, lets the host
+                             detect plugins built against an older header */
+    const char* name;     /* letters, digits and underscores, copied by the host */
+    int arity;            /* number of arguments, DESKCALC_VARIADIC for one or more */
+    int pure;             /* nonzero if the result depends on the arguments only */
+    dc_scalar_fn scalar;  /* required */
+    dc_batch_fn batch;    /* optional, NULL calls scalar for every element */
+} dc_function;
+
+typedef struct dc_host {
+    int abi_version;
+    void* context;
+    /* returns 0 if the function was registered */
+    int (*register_function)(void* context, const dc_function* function);
+} dc_host;
+
+/* Exported by every plugin, returns 0 on success. A failure unloads the plugin
+ * without registering any of its functions. */
+typedef int (*dc_plugin_init_fn)(const dc_host* host);
+#define DESKCALC_PLUGIN_INIT "deskcalc_plugin_init"
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "ListView.hpp"
+#include "types.hpp"
+
+// Dense complex linear algebra for the small matrices of network analysis
+// (impedance and admittance matrices, two-port parameters). Inner loops run on
+// the interleaved real and imaginary parts, so the compiler vectorizes them;
+// unlike std::complex they do not special-case infinite operands.
+
+Matrix add(const Matrix& left, const Matrix& right);
+Matrix sub(const Matrix& left, const Matrix& right);
+Matrix scale(const Matrix& m, const Complex& factor);
+Matrix transpose(const Matrix& m);
+
+// Cache-blocked product
+Matrix multiply(const Matrix& left, const Matrix& right);
+List multiply(const Matrix& m, ListView vec);
+
+// Integer powers, negative ones of the inverse
+Matrix matrix_pow(const Matrix& m, std::int64_t exp);
+
+// LU decomposition with partial pivoting, PA = LU, of a square matrix
+class LU {
+public:
+    explicit LU(Matrix m);
+
+    bool is_singular() const noexcept { return singular; }
+    // x with A x = b for every column of b, throws if A is singular
+    Matrix solve(const Matrix& b) const;
+    List solve(ListView b) const;
+    Complex determinant() const noexcept;
+
+private:
+    Matrix lu;  // L below the diagonal (unit diagonal implied), U on and above it
+    std::vector<std::size_t> perm;
+    bool oddPermutation{};
+    bool singular{};
+};
+
+Matrix inverse(const Matrix& m);
+Complex determinant(const Matrix& m);
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "ListSource.hpp"
 #include "types.hpp"
 
 constexpr bool is_zero(const Complex& num)
@@ -20,18 +21,37 @@ T safe_mod(T&& left, T&& right)
 }
 
 double factorial(int n);
-Complex factorial(const Complex& num);
+Complex factorial(const Complex& num);  // Gamma(num + 1) for non-integers
+Complex tgamma(const Complex& z);
 Complex impedance_parallel(const Complex& R1, const Complex& R2);
 
-std::size_t len(const List& list) noexcept;
-Complex sum(const List& list);
-Complex sqr_sum(const List& list);
-Complex avg(const List& list);
-Complex standard_deviation(const List& list);
-Complex standard_uncertainty(const List& list);
+enum class Summation {
+    Pairwise,     // cascade summation, error grows with log(n)
+    Compensated   // Kahan-Neumaier, error independent of n
+};
+
+// Per-session settings for list reductions
+struct ReduceOptions {
+    Summation summation{ Summation::Pairwise };
+    std::size_t parallelThreshold{ 1 << 20 };  // shorter lists are reduced on the calling thread
+    unsigned threads{};                         // 0 = one per hardware thread
+};
+
+using Reduction = Complex(*)(ListSource, const ReduceOptions&);
+
+// Streamed sources give the same results as the stored list, standard_deviation
+// and standard_uncertainty read them twice
+std::size_t len(ListSource list);
+Complex sum(ListSource list, const ReduceOptions& opts = {});
+Complex sqr_sum(ListSource list, const ReduceOptions& opts = {});
+Complex avg(ListSource list, const ReduceOptions& opts = {});
+Complex standard_deviation(ListSource list, const ReduceOptions& opts = {});
+Complex standard_uncertainty(ListSource list, const ReduceOptions& opts = {});
 
 Complex sqr(const Complex& num);
+Complex int_pow(Complex base, unsigned long long exp);
 Complex pretty_pow(const Complex& base, const Complex& exp);
+Complex literal_pow(const Complex& base, double exp);  // exp was written as a literal
 
 // https://stackoverflow.com/questions/1903954/is-there-a-standard-sign-function-signum-sgn-in-c-c
 template <typename T>
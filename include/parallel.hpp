@@ -0,0 +1,50 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+inline unsigned hardware_threads() noexcept
+{
+    const auto n = std::thread::hardware_concurrency();
+    return n ? n : 1;
+}
+
+// Calls f(i) for every i in [0, count) using up to `threads` threads, the calling
+// thread included. Indices are claimed one at a time from a shared counter, so a
+// thread that finishes a cheap item early immediately picks up the next one.
+// The first exception thrown by f is rethrown once all threads have finished.
+template<class F>
+void parallel_for(std::size_t count, unsigned threads, F f)
+{
+    std::atomic<std::size_t> next{ 0 };
+    std::exception_ptr failure;
+    std::mutex failureMutex;
+
+    const auto work = [&] {
+        try {
+            for (std::size_t i; (i = next++) < count; )
+                f(i);
+        }
+        catch (...) {
+            std::lock_guard<std::mutex> lock{ failureMutex };
+            if (!failure)
+                failure = std::current_exception();
+            next = count;
+        }
+    };
+
+    std::vector<std::thread> pool;
+    const auto numThreads = std::min<std::size_t>(std::max(threads, 1u), count);
+    for (std::size_t t = 1; t < numThreads; ++t)
+        pool.emplace_back(work);
+    work();
+    for (auto& t : pool)
+        t.join();
+
+    if (failure)
+        std::rethrow_exception(failure);
+}
@@ -3,11 +3,50 @@
 #include <complex>
 #include <functional>
 #include <iostream>
+#include <memory>
 #include <vector>
 
 using Complex = std::complex<double>;
 using List = std::vector<Complex>;
-using Func = Complex(*)(const List&); // using Func = std::function<Complex(const List&)>;
+
+// Dense complex matrix, stored row by row
+class Matrix {
+public:
+    Matrix() = default;
+    Matrix(std::size_t rows, std::size_t cols)
+        : nRows{ rows }, nCols{ cols }, elems(rows * cols) { }
+
+    static Matrix identity(std::size_t n)
+    {
+        Matrix m{ n, n };
+        for (std::size_t i = 0; i < n; ++i)
+            m(i, i) = 1;
+        return m;
+    }
+
+    std::size_t rows() const noexcept { return nRows; }
+    std::size_t cols() const noexcept { return nCols; }
+    bool is_square() const noexcept { return nRows == nCols; }
+
+    Complex& operator()(std::size_t row, std::size_t col) noexcept { return elems[row * nCols + col]; }
+    const Complex& operator()(std::size_t row, std::size_t col) const noexcept { return elems[row * nCols + col]; }
+    Complex* row(std::size_t i) noexcept { return elems.data() + i * nCols; }
+    const Complex* row(std::size_t i) const noexcept { return elems.data() + i * nCols; }
+    const List& elements() const noexcept { return elems; }
+
+    friend bool operator==(const Matrix& left, const Matrix& right)
+    {
+        return left.nRows == right.nRows && left.nCols == right.nCols && left.elems == right.elems;
+    }
+    friend bool operator!=(const Matrix& left, const Matrix& right) { return !(left == right); }
+
+private:
+    std::size_t nRows{};
+    std::size_t nCols{};
+    List elems;
+};
+
+using MatrixPtr = std::shared_ptr<const Matrix>;
 
 template<class T>
 void print_complex(std::ostream& os, const std::complex<T>& n)
@@ -26,8 +65,8 @@ void print_complex(std::ostream& os, const std::complex<T>& n)
         os << n.real();
 }
 
-template<class T>
-void print_list(std::ostream& os, const std::vector<T>& v)
+template<class Container>
+void print_list(std::ostream& os, const Container& v)
 {
     os << '[';
     std::string sep;
@@ -38,3 +77,18 @@ void print_list(std::ostream& os, const std::vector<T>& v)
     }
     os << ']';
 }
+
+inline void print_matrix(std::ostream& os, const Matrix& m)
+{   // [1, 2; 3, 4], the syntax of matrix literals
+    os << '[';
+    for (std::size_t i = 0; i < m.rows(); ++i) {
+        for (std::size_t j = 0; j < m.cols(); ++j) {
+            if (j)
+                os << ", ";
+            print_complex(os, m(i, j));
+        }
+        if (i + 1 < m.rows())
+            os << "; ";
+    }
+    os << ']';
+}
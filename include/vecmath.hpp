@@ -0,0 +1,25 @@
+#pragma once
+
+#include <cstddef>
+
+#include "types.hpp"
+
+// Elementary functions over arrays, for built-ins applied to lists. Blocks of
+// real numbers are split off and run through polynomial kernels the compiler
+// vectorizes, which stay within a few ULP of the std:: functions. Complex
+// elements and real ones outside a kernel's range fall back to std::.
+// out may be the same array as in.
+
+void vec_sin(const Complex* in, Complex* out, std::size_t n);
+void vec_cos(const Complex* in, Complex* out, std::size_t n);
+void vec_exp(const Complex* in, Complex* out, std::size_t n);  // also complex blocks, as e^re (cos im + i sin im)
+void vec_log(const Complex* in, Complex* out, std::size_t n);
+void vec_sqrt(const Complex* in, Complex* out, std::size_t n);
+void vec_abs(const Complex* in, Complex* out, std::size_t n);  // also complex blocks, as sqrt(re^2 + im^2)
+
+// The real kernels, only valid within their range: |x| <= 1e5 for sin and
+// cos, |x| <= 708 for exp and normal positive numbers for log
+void real_sin(const double* x, double* y, std::size_t n) noexcept;
+void real_cos(const double* x, double* y, std::size_t n) noexcept;
+void real_exp(const double* x, double* y, std::size_t n) noexcept;
+void real_log(const double* x, double* y, std::size_t n) noexcept;
@@ -0,0 +1,209 @@
+#include "Batch.hpp"
+
+#include <condition_variable>
+#include <fstream>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "BoundedQueue.hpp"
+#include "parallel.hpp"
+#include "SymbolTable.hpp"
+
+namespace {
+
+struct Output {
+    enum class Type { Value, List, Matrix, Error };
+
+    explicit Output(const Complex& value)
+        : type{ Type::Value }, value{ value } { }
+    explicit Output(List list)
+        : type{ Type::List }, list{ std::move(list) } { }
+    explicit Output(MatrixPtr matrix)
+        : type{ Type::Matrix }, matrix{ std::move(matrix) } { }
+    explicit Output(std::string error)
+        : type{ Type::Error }, error{ std::move(error) } { }
+
+    Type type;
+    Complex value;
+    List list;
+    MatrixPtr matrix;
+    std::string error;
+};
+
+using Lines = std::vector<std::string>;
+using Outputs = std::vector<Output>;
+
+constexpr std::size_t chunkSize{ 1024 };
+constexpr std::size_t queueSize{ 16 };
+
+}   // anonymous namespace
+
+void print_results(Parser& parser, OutputBuffer& out)
+{
+    parser.on_result([&parser, &out](const Complex& n) {
+        parser.symbol_table().set_var("_", n);
+        parser.symbol_table().set_var("ans", n);
+        out.write(n);
+        out.write('\n');
+    });
+
+    parser.on_list_result([&out](ListView l) {
+        out.write(l);
+        out.write('\n');
+    });
+
+    parser.on_matrix_result([&out](const Matrix& m) {
+        out.write(m);
+        out.write('\n');
+    });
+}
+
+void run_batch(Parser& parser, std::istream& in, OutputBuffer& out, std::ostream& err)
+{
+    BoundedQueue<Lines> input{ queueSize };
+    BoundedQueue<Outputs> output{ queueSize };
+
+    std::thread reader{ [&] {
+        Lines chunk;
+        for (std::string s; std::getline(in, s); ) {
+            chunk.push_back(std::move(s));
+            if (chunk.size() == chunkSize) {
+                if (!input.push(std::move(chunk)))
+                    break;
+                chunk.clear();
+            }
+        }
+        if (chunk.size())
+            input.push(std::move(chunk));
+        input.close();
+    } };
+
+    std::thread writer{ [&] {
+        for (Outputs chunk; output.pop(chunk); ) {
+            for (const auto& o : chunk) {
+                switch (o.type) {
+                case Output::Type::Value:
+                    out.write(o.value);
+                    break;
+                case Output::Type::List:
+                    out.write(o.list);
+                    break;
+                case Output::Type::Matrix:
+                    out.write(*o.matrix);
+                    break;
+                case Output::Type::Error:
+                    out.flush();  // keeps the order on a terminal showing both
+                    err << o.error << '\n';
+                    continue;
+                }
+                out.write('\n');
+            }
+        }
+        out.flush();
+    } };
+
+    Outputs results;
+    struct Handlers {  // the handlers refer to results, reset them when leaving
+        Parser& parser;
+        ~Handlers()
+        {
+            parser.on_result(nullptr);
+            parser.on_list_result(nullptr);
+            parser.on_matrix_result(nullptr);
+        }
+    } handlers{ parser };
+    parser.on_result([&](const Complex& n) {
+        parser.symbol_table().set_var("_", n);
+        parser.symbol_table().set_var("ans", n);
+        results.emplace_back(n);
+    });
+    parser.on_list_result([&](ListView l) { results.emplace_back(l.to_list()); });
+    parser.on_matrix_result([&](const Matrix& m) { results.emplace_back(std::make_shared<const Matrix>(m)); });
+
+    try {
+        for (Lines chunk; input.pop(chunk); ) {
+            for (const auto& line : chunk) {
+                try {
+                    parser.parse(line);
+                }
+                catch (const std::runtime_error& e) {
+                    results.emplace_back(std::string{ e.what() });
+                }
+            }
+            output.push(std::move(results));
+            results.clear();
+        }
+    }
+    catch (...) {
+        input.close();
+        output.close();
+        reader.join();
+        writer.join();
+        throw;
+    }
+    output.close();
+    reader.join();
+    writer.join();
+}
+
+std::size_t run_files(const std::vector<std::string>& paths, unsigned jobs, OutputBuffer& out, std::ostream& err)
+{   // files are evaluated on a pool of `jobs` threads while this thread writes
+    // the collected output of the next file in line as soon as it is done
+    struct Session {
+        std::string output;
+        std::string error;
+        bool done{};
+    };
+    std::vector<Session> sessions(paths.size());
+    std::mutex mutex;
+    std::condition_variable finished;
+
+    std::thread pool{ [&] {
+        parallel_for(paths.size(), jobs, [&](std::size_t i) {
+            std::string error;
+            std::ostringstream os;
+            try {
+                std::ifstream ifs{ paths[i] };
+                if (!ifs)
+                    throw std::runtime_error{ "Cannot open file " + paths[i] };
+                SymbolTable table;
+                Parser parser{ table };
+                OutputBuffer sessionOut{ os };
+                print_results(parser, sessionOut);
+                parser.parse(ifs);
+            }
+            catch (const std::exception& e) {
+                error = paths[i] + ": " + e.what();
+            }
+
+            std::lock_guard<std::mutex> lock{ mutex };
+            sessions[i].output = os.str();
+            sessions[i].error = std::move(error);
+            sessions[i].done = true;
+            finished.notify_all();
+        });
+    } };
+
+    std::size_t failed{};
+    for (auto& session : sessions) {
+        std::unique_lock<std::mutex> lock{ mutex };
+        finished.wait(lock, [&session] { return session.done; });
+        lock.unlock();
+
+        out.write(session.output);
+        if (session.error.size()) {
+            out.flush();
+            err << session.error << '\n';
+            ++failed;
+        }
+        std::string{}.swap(session.output);
+    }
+    out.flush();
+    pool.join();
+    return failed;
+}
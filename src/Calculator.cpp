@@ -1,14 +1,24 @@
 #include "Calculator.hpp"
 
+#include <algorithm>
+#include <cctype>
 #include <fstream>
 #include <iostream>
+#include <limits>
 #include <sstream>
+#include <vector>
 
 #include "mps/str_util.hpp"
 #include "mps/clipboard.hpp"
 #include "mps/console_util.hpp"
+#include "mps/stream_util.hpp"
 
+#include "Batch.hpp"
+#include "Import.hpp"
 #include "math_util.hpp"
+#include "Plugin.hpp"
+#include "Snapshot.hpp"
+#include "TokenStream.hpp"
 #include "types.hpp"
 
 using std::cin;
@@ -28,31 +38,77 @@ Calculator::Calculator()
         intro = s.str();
     }
 
-    parser.on_result([this](const auto& n) {
-        parser.symbol_table().set_var("_", n);
-        parser.symbol_table().set_var("ans", n);
-        print_complex(cout, n);
-        cout << '\n';
-    });
+    register_result_handlers();
+}
+
+static void check_list_name(const SymbolTable& table, const std::string& name)
+{
+    TokenStream ts;
+    ts.set_input(name);
+    if (ts.get().kind != Kind::String || ts.get().kind != Kind::End)
+        throw std::runtime_error{ name + " is not a valid list name" };
+    if (table.is_const(name))
+        throw std::runtime_error{ name + " is a constant" };
+    if (table.is_reserved_func(name))
+        throw std::runtime_error{ name + " is a built-in function" };
+}
+
+void Calculator::register_result_handlers()
+{
+    print_results(parser, out);
 }
 
 void Calculator::run(int argc, char* argv[])
 {
-    switch (argc) {
-    case 1:
+    std::vector<std::string> args(argv + 1, argv + argc);
+
+    if (args.size() && args.front() == "--batch") {
+        if (args.size() == 1 || args[1] == "-")
+            run_batch(cin);
+        else if (args.size() == 2) {
+            std::ifstream ifs{ args[1] };
+            if (!ifs)
+                throw std::runtime_error{ "Cannot open file " + args[1] };
+            run_batch(ifs);
+        }
+        else
+            throw std::runtime_error{ "Invalid number of arguments" };
+        return;
+    }
+
+    const auto jobsOpt = std::find(begin(args), end(args), "-j");
+    if (jobsOpt != end(args)) {
+        int jobs{};
+        if (next(jobsOpt) == end(args) || !mps::parse_int(*next(jobsOpt), jobs))
+            throw std::runtime_error{ "-j expects a positive number of jobs" };
+        args.erase(jobsOpt, jobsOpt + 2);
+        if (args.empty())
+            throw std::runtime_error{ "No files to run" };
+        run_files(args, static_cast<unsigned>(jobs));
+        return;
+    }
+
+    switch (args.size()) {
+    case 0:
         run_cli();
         break;
-    case 2:
-        if (std::string(argv[1]) == "-")
+    case 1:
+        if (args.front() == "-")
             run_cli();
-        else if (!run_file(argv[1]))
-            parser.parse(argv[1]);
+        else if (!run_file(args.front()))
+            parser.parse(args.front());
         break;
     default:
-        throw std::runtime_error{ "Invalid number of arguments" };
+        run_files(args, 1);
     }
 }
 
+void Calculator::run_files(const std::vector<std::string>& paths, unsigned jobs)
+{
+    if (const auto failed = ::run_files(paths, jobs, out, std::cerr))
+        throw std::runtime_error{ std::to_string(failed) + " of " + std::to_string(paths.size()) + " files failed" };
+}
+
 bool Calculator::run_file(const std::string& path)
 {
     if (std::ifstream ifs{ path }) {
@@ -62,6 +118,18 @@ bool Calculator::run_file(const std::string& path)
     return false;
 }
 
+void Calculator::run_batch(std::istream& is)
+{
+    try {
+        ::run_batch(parser, is, out, std::cerr);
+    }
+    catch (...) {
+        register_result_handlers();
+        throw;
+    }
+    register_result_handlers();
+}
+
 void Calculator::run_cli()
 {
     cout << intro 
@@ -76,12 +144,29 @@ void Calculator::run_cli()
                 parser.parse(s);
         }
         catch (const std::runtime_error& e) {
+            out.flush();
             std::cerr << e.what() << '\n';
         }
+        out.flush();
         cout << prompt;
     }
 }
 
+// Whether a line starting with the name of a command taking an argument is an
+// expression instead, like load = 50 or save * 2. An operator continues an
+// expression if the name is defined or it is followed by a space, so paths
+// like /tmp/file stay arguments of the command.
+static bool is_expression(const SymbolTable& table, const std::string& word, const std::string& arg)
+{
+    if (arg.empty())
+        return table.isset(word);
+    if (arg[0] == '=' || arg[0] == '(' || arg[0] == '[')
+        return true;
+    static const std::string operators{ "+-*/^%!<>|&" };
+    return operators.find(arg[0]) != std::string::npos
+        && (table.isset(word) || arg.size() == 1 || std::isspace(static_cast<unsigned char>(arg[1])));
+}
+
 bool Calculator::handle_cmd(const std::string& cmd)
 {
     auto found = commands.find(mps::str::tolower(cmd));
@@ -89,6 +174,15 @@ bool Calculator::handle_cmd(const std::string& cmd)
         found->second();
         return true;
     }
+
+    const auto space = cmd.find(' ');
+    const auto word = cmd.substr(0, space);
+    const auto arg = space == std::string::npos ? "" : mps::str::trim(cmd.substr(space + 1));
+    auto paramCmd = paramCommands.find(mps::str::tolower(word));
+    if (paramCmd != end(paramCommands) && !is_expression(parser.symbol_table(), word, arg)) {
+        paramCmd->second(arg);
+        return true;
+    }
     return false;
 }
 
@@ -96,6 +190,8 @@ void Calculator::register_commands()
 {
     static const std::string helpText{
         "For a list of operators, commands and functions please view the readme file\n"
+        "Built-ins splice list arguments (hypot([6, 8]) is hypot(6, 8)), functions loaded with\n"
+        "plugin <file> map them element by element (model(x, 2) is a list like x)\n"
     };
 
     commands["help"] = [] { std::cout << helpText; };
@@ -113,6 +209,7 @@ void Calculator::register_commands()
     commands["clear vars"] = [this] { parser.symbol_table().clear_vars(); };
     commands["clear funcs"] = [this] { parser.symbol_table().clear_funcs(); };
     commands["clear lists"] = [this] { parser.symbol_table().clear_lists(); };
+    commands["clear matrices"] = [this] { parser.symbol_table().clear_matrices(); };
 
     commands["hide vars"] = [this] { parser.set_vardef_is_res(false); };
     commands["show vars"] = [this] { parser.set_vardef_is_res(true); };
@@ -138,9 +235,27 @@ void Calculator::register_commands()
             cout << "\nLists:\n~~~~~~\n";
         for (const auto& l : lists) {
             cout << "  " << l.first << " = ";
-            print_list(cout, l.second);
+            print_list(cout, l.second.view());
             cout << '\n';
         }
+
+        const auto& matrices = parser.symbol_table().matrices();
+        if (matrices.size())
+            cout << "\nMatrices:\n~~~~~~~~~\n";
+        for (const auto& m : matrices) {
+            cout << "  " << m.first << " = ";
+            print_matrix(cout, *m.second);
+            cout << '\n';
+        }
+
+        const auto& natives = parser.symbol_table().natives();
+        if (natives.size())
+            cout << "\nPlugin functions:\n~~~~~~~~~~~~~~~~~\n";
+        for (const auto& n : natives) {
+            const auto& f = *n.second;
+            cout << "  " << f.name() << '/' << (f.arity() < 0 ? std::string{ "n" } : std::to_string(f.arity()))
+                 << (f.is_pure() ? "" : " (impure)") << "  " << f.library() << '\n';
+        }
     };
 
     commands["run"] = [this] {
@@ -149,6 +264,72 @@ void Calculator::register_commands()
             run_file(fname);
     };
 
+    paramCommands["save"] = [this](const std::string& path) {
+        if (path.empty())
+            throw std::runtime_error{ "Usage: save <file>" };
+        save_snapshot(parser.symbol_table(), path);
+    };
+
+    paramCommands["load"] = [this](const std::string& path) {
+        if (path.empty())
+            throw std::runtime_error{ "Usage: load <file>" };
+        load_snapshot(parser.symbol_table(), path);
+    };
+
+    paramCommands["plugin"] = [this](const std::string& path) {
+        if (path.empty())
+            throw std::runtime_error{ "Usage: plugin <file>" };
+        const auto n = load_plugin(parser.symbol_table(), path);
+        cout << n << (n == 1 ? " function" : " functions") << " loaded from " << path << '\n';
+    };
+
+    paramCommands["import"] = [this](const std::string& args) {
+        std::istringstream is{ args };
+        std::string name, path, columnStr;
+        int column{ 1 };
+        if (!(is >> name >> path) || (is >> columnStr && !mps::parse_int(columnStr, column)))
+            throw std::runtime_error{ "Usage: import <name> <file> [column]" };
+
+        auto& table = parser.symbol_table();
+        check_list_name(table, name);
+        auto list = import_list(path, static_cast<std::size_t>(column));
+        table.remove_var(name);
+        table.remove_matrix(name);
+        table.remove_func(name);
+        table.set_list(name, std::move(list));
+    };
+
+    paramCommands["map"] = [this](const std::string& args) {
+        std::istringstream is{ args };
+        std::string name, path, mode;
+        if (!(is >> name >> path) || (is >> mode && mode != "cow"))
+            throw std::runtime_error{ "Usage: map <name> <file> [cow]" };
+
+        auto& table = parser.symbol_table();
+        check_list_name(table, name);
+        table.map_list(name, path, mode == "cow" ? MapMode::CopyOnWrite : MapMode::ReadOnly);
+        table.remove_var(name);
+        table.remove_matrix(name);
+        table.remove_func(name);
+    };
+
+    paramCommands["append"] = paramCommands["extend"] = [this](const std::string& args) {
+        const auto space = args.find(' ');
+        if (space == std::string::npos)
+            throw std::runtime_error{ "Usage: append <list> <expression>" };
+        const auto name = args.substr(0, space);
+        check_list_name(parser.symbol_table(), name);
+        parser.append(name, args.substr(space + 1));
+    };
+
+    paramCommands["export"] = [this](const std::string& args) {
+        std::istringstream is{ args };
+        std::string name, path;
+        if (!(is >> name >> path))
+            throw std::runtime_error{ "Usage: export <list> <file>" };
+        write_raw_list(parser.symbol_table().list(name), path);
+    };
+
     commands["copy"] = [this] {
         auto&& str = mps::str::to_string(parser.symbol_table().value_of("ans"));
         mps::set_clipboard_text(std::move(str));
@@ -166,6 +347,40 @@ void Calculator::register_commands()
         cout << "Sorry, table feature not implemented yet.\n";
     };
 
+    commands["precision"] = [this] {
+        cout << "digits (0 = shortest round-trip): ";
+        int digits{};
+        if (!(cin >> digits) || digits < 0) {
+            mps::recover_line(cin);
+            return;
+        }
+        cin.ignore();
+        out.set_precision(digits);
+    };
+
+    paramCommands["summation"] = [this](const std::string& mode) {
+        auto opts = parser.symbol_table().reduce_options();
+        if (mode == "pairwise")
+            opts.summation = Summation::Pairwise;
+        else if (mode == "kahan")
+            opts.summation = Summation::Compensated;
+        else
+            throw std::runtime_error{ "Usage: summation pairwise|kahan" };
+        parser.symbol_table().set_reduce_options(opts);
+    };
+
+    paramCommands["parallel"] = [this](const std::string& arg) {
+        auto opts = parser.symbol_table().reduce_options();
+        int minLength{};
+        if (arg == "off")
+            opts.parallelThreshold = std::numeric_limits<std::size_t>::max();
+        else if (mps::parse_int(arg, minLength))
+            opts.parallelThreshold = static_cast<std::size_t>(minLength);
+        else
+            throw std::runtime_error{ "Usage: parallel off|<min list length>" };
+        parser.symbol_table().set_reduce_options(opts);
+    };
+
     commands["dec"] = [] {
         cout << "hex/bin (W/ leading 0): ";
         int val{};
@@ -0,0 +1,226 @@
+#include "Histogram.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+#include "parallel.hpp"
+
+namespace {
+
+constexpr std::size_t blockSize{ 256 };
+constexpr std::size_t maxBins{ 100000000 };
+
+// Long lists are cut into a number of ranges that depends on the length and the
+// number of bins only. Each range fills its own partial histogram, and these are
+// added up in a fixed tree, so sums do not depend on how many threads filled them.
+constexpr std::size_t rangeSize{ 1 << 16 };
+constexpr std::size_t maxRanges{ 64 };
+constexpr std::size_t maxPartialBins{ 1 << 22 };  // of all partial histograms together
+
+struct Partial {
+    Partial(std::size_t bins, bool withSums)
+        : counts(bins), sums(withSums ? bins : 0) { }
+
+    void add(const Partial& other) noexcept
+    {
+        for (std::size_t i = 0; i < counts.size(); ++i)
+            counts[i] += other.counts[i];
+        for (std::size_t i = 0; i < sums.size(); ++i)
+            sums[i] += other.sums[i];
+    }
+
+    std::vector<std::uint64_t> counts;
+    std::vector<double> sums;  // empty if only counts are needed
+};
+
+std::size_t range_count(std::size_t n, std::size_t bins)
+{   // a single shared histogram if there are too many bins for one per range
+    const auto ranges = std::min((n + rangeSize - 1) / rangeSize, maxRanges);
+    return std::max<std::size_t>(std::min(ranges, maxPartialBins / bins), 1);
+}
+
+// Adds partial[1], ..., partial[n - 1] to partial[0]
+void combine(Partial* partial, std::size_t n) noexcept
+{
+    if (n == 1)
+        return;
+    const auto half = n / 2;
+    combine(partial, half);
+    combine(partial + half, n - half);
+    partial[0].add(partial[half]);
+}
+
+void check_real(const Complex* elems, std::size_t n)
+{
+    for (std::size_t i = 0; i < n; ++i) {
+        if (elems[i].imag())
+            throw std::runtime_error{ "Only real numbers can be binned" };
+    }
+}
+
+template<class F>
+void for_each_block(ListSource list, F f)
+{
+    if (const auto stream = list.as_stream()) {
+        List block(blockSize);
+        stream->restart();
+        while (const auto n = stream->read(block.data(), block.size()))
+            f(block.data(), n);
+    }
+    else {
+        const auto view = list.view();
+        for (std::size_t first = 0; first < view.size(); first += blockSize)
+            f(view.data() + first, std::min(blockSize, view.size() - first));
+    }
+}
+
+void add_block(const Complex* elems, std::size_t n, const Bins& bins, Partial& partial)
+{   // bin indices are computed for the whole block first, a loop without branches
+    // the compiler vectorizes; out of range elements get the index bins.count
+    const auto x = reinterpret_cast<const double*>(elems);
+    const auto scale = static_cast<double>(bins.count) / (bins.high - bins.low);
+    const auto last = static_cast<double>(bins.count - 1);
+    const auto outside = static_cast<double>(bins.count);
+    double index[blockSize];
+    bool complex{};
+    for (std::size_t i = 0; i < n; ++i) {
+        const auto v = x[2 * i];
+        const auto t = std::min((v - bins.low) * scale, last);
+        index[i] = v >= bins.low && v <= bins.high ? t : outside;
+        complex |= x[2 * i + 1] != 0;
+    }
+    if (complex)
+        throw std::runtime_error{ "Only real numbers can be binned" };
+    if (partial.sums.empty()) {
+        for (std::size_t i = 0; i < n; ++i) {
+            const auto bin = static_cast<std::size_t>(index[i]);
+            if (bin < bins.count)
+                ++partial.counts[bin];
+        }
+        return;
+    }
+    for (std::size_t i = 0; i < n; ++i) {
+        const auto bin = static_cast<std::size_t>(index[i]);
+        if (bin < bins.count) {
+            ++partial.counts[bin];
+            partial.sums[bin] += x[2 * i];
+        }
+    }
+}
+
+// The bin index is (v - low) * count / (high - low), which overflows for
+// ranges too narrow for double
+void check_scale(double low, double high, std::size_t count)
+{
+    if (!std::isfinite(static_cast<double>(count) / (high - low)))
+        throw std::runtime_error{ "The range of the bins is too narrow" };
+}
+
+}   // anonymous namespace
+
+Bins data_bins(ListSource list, std::size_t count)
+{
+    auto low = std::numeric_limits<double>::infinity();
+    auto high = -low;
+    for_each_block(list, [&](const Complex* elems, std::size_t n) {
+        check_real(elems, n);
+        for (std::size_t i = 0; i < n; ++i) {
+            low = std::min(low, elems[i].real());
+            high = std::max(high, elems[i].real());
+        }
+    });
+    if (low > high)
+        throw std::runtime_error{ "Cannot bin a list without numbers" };
+    if (!std::isfinite(high - low))
+        throw std::runtime_error{ "Cannot bin infinite values without a given range" };
+    if (low == high) {  // a single value, centered in its bins like numpy does
+        low -= 0.5;
+        high += 0.5;
+    }
+    check_scale(low, high, count);
+    return { low, high, count };
+}
+
+Bins make_bins(ListSource list, const List& params)
+{
+    if ((params.size() != 1 && params.size() != 3)
+        || std::any_of(cbegin(params), cend(params), [](const Complex& c) { return c.imag() != 0; }))
+        throw std::runtime_error{ "Expected the number of bins, optionally followed by the low and high end" };
+    const auto count = params[0].real();
+    if (count != std::trunc(count) || count < 1 || count > maxBins)
+        throw std::runtime_error{ "The number of bins must be a whole number from 1 to 1e8" };
+    if (params.size() == 1)
+        return data_bins(list, static_cast<std::size_t>(count));
+    if (!(params[1].real() < params[2].real()) || !std::isfinite(params[2].real() - params[1].real()))
+        throw std::runtime_error{ "The low end of the bins must be below the high end" };
+    check_scale(params[1].real(), params[2].real(), static_cast<std::size_t>(count));
+    return { params[1].real(), params[2].real(), static_cast<std::size_t>(count) };
+}
+
+List bin_centers(const Bins& bins)
+{
+    List centers(bins.count);
+    const auto width = (bins.high - bins.low) / static_cast<double>(bins.count);
+    for (std::size_t i = 0; i < bins.count; ++i)
+        centers[i] = bins.low + (static_cast<double>(i) + 0.5) * width;
+    return centers;
+}
+
+List binned(ListSource list, const Bins& bins, BinStat stat, const ReduceOptions& opts)
+{
+    const auto n = list.size();
+    const auto withSums = stat != BinStat::Count;
+    const auto parts = range_count(n, bins.count);
+    // range p starts at range_start(p), a multiple of the block size, so streams
+    // read whole blocks of a single range
+    const auto range_start = [&](std::size_t p) {
+        return p == parts ? n : n * p / parts / blockSize * blockSize;
+    };
+    std::vector<Partial> partial(parts, Partial{ bins.count, withSums });
+    if (const auto stream = list.as_stream()) {
+        std::size_t p{}, pos{};
+        for_each_block(list, [&](const Complex* elems, std::size_t size) {
+            while (pos >= range_start(p + 1))
+                ++p;
+            add_block(elems, size, bins, partial[p]);
+            pos += size;
+        });
+    }
+    else {
+        const auto view = list.view();
+        const auto add_range = [&](std::size_t p) {
+            const auto first = range_start(p);
+            for_each_block(ListView{ view.data() + first, range_start(p + 1) - first },
+                           [&](const Complex* elems, std::size_t size) { add_block(elems, size, bins, partial[p]); });
+        };
+        const auto threads = opts.threads ? opts.threads : hardware_threads();
+        if (n >= opts.parallelThreshold && threads > 1)
+            parallel_for(parts, threads, add_range);
+        else {
+            for (std::size_t p = 0; p < parts; ++p)
+                add_range(p);
+        }
+    }
+    combine(partial.data(), parts);
+
+    const auto& total = partial[0];
+    List res(bins.count);
+    for (std::size_t b = 0; b < bins.count; ++b) {
+        switch (stat) {
+        case BinStat::Count:
+            res[b] = static_cast<double>(total.counts[b]);
+            break;
+        case BinStat::Sum:
+            res[b] = total.sums[b];
+            break;
+        case BinStat::Mean:
+            res[b] = total.counts[b] ? total.sums[b] / static_cast<double>(total.counts[b]) : std::nan("");
+            break;
+        }
+    }
+    return res;
+}
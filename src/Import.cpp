@@ -0,0 +1,165 @@
+#include "Import.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+#include "MappedFile.hpp"
+#include "parallel.hpp"
+
+namespace {
+
+constexpr std::size_t chunkBytes{ 1 << 20 };
+
+struct CsvChunk {
+    List values;
+    const char* badLine{};  // first line without a number in the column
+};
+
+const char* line_end(const char* first, const char* last)
+{
+    return std::find(first, last, '\n');
+}
+
+char detect_separator(const char* first, const char* eol)
+{
+    if (std::find(first, eol, '\t') != eol)
+        return '\t';
+    if (std::find(first, eol, ';') != eol)
+        return ';';
+    return ',';
+}
+
+bool is_blank(char c)
+{
+    return c == ' ' || c == '\t' || c == '\r' || c == '"';
+}
+
+bool parse_field(const char* first, const char* eol, char sep, std::size_t column, double& value)
+{
+    for (; column > 1; --column) {
+        first = std::find(first, eol, sep);
+        if (first == eol)
+            return false;
+        ++first;
+    }
+    auto last = std::find(first, eol, sep);
+    while (first != last && is_blank(*first))
+        ++first;
+    while (last != first && is_blank(last[-1]))
+        --last;
+    if (first != last && *first == '+')
+        ++first;
+    const auto res = std::from_chars(first, last, value);
+    return res.ec == std::errc{} && res.ptr == last;
+}
+
+bool is_empty_line(const char* first, const char* eol)
+{
+    return std::all_of(first, eol, [](char c) { return c == ' ' || c == '\t' || c == '\r'; });
+}
+
+CsvChunk parse_chunk(const char* first, const char* last, char sep, std::size_t column)
+{
+    CsvChunk chunk;
+    chunk.values.reserve(static_cast<std::size_t>(std::count(first, last, '\n')) + 1);
+    while (first != last) {
+        const auto eol = line_end(first, last);
+        double value;
+        if (parse_field(first, eol, sep, column, value))
+            chunk.values.emplace_back(value);
+        else if (!is_empty_line(first, eol)) {
+            chunk.badLine = first;
+            break;
+        }
+        first = eol == last ? last : eol + 1;
+    }
+    return chunk;
+}
+
+std::uint64_t byteswap(std::uint64_t x) noexcept
+{
+    std::uint64_t res{};
+    for (int i = 0; i < 8; ++i, x >>= 8)
+        res = (res << 8) | (x & 0xff);
+    return res;
+}
+
+}   // anonymous namespace
+
+List import_csv(const std::string& path, std::size_t column)
+{
+    if (!column)
+        throw std::runtime_error{ "Columns are counted from 1" };
+    const MappedFile file{ path };
+    const auto first = file.data();
+    const auto last = first + file.size();
+
+    auto body = first;
+    const auto headerEnd = line_end(first, last);
+    const auto sep = detect_separator(first, headerEnd);
+    double value;
+    if (!parse_field(first, headerEnd, sep, column, value))
+        body = headerEnd == last ? last : headerEnd + 1;
+
+    std::vector<const char*> bounds{ body };
+    while (bounds.back() != last) {
+        const auto from = bounds.back() + std::min<std::size_t>(chunkBytes, last - bounds.back());
+        const auto eol = line_end(from, last);
+        bounds.push_back(eol == last ? last : eol + 1);
+    }
+
+    std::vector<CsvChunk> chunks(bounds.size() - 1);
+    parallel_for(chunks.size(), hardware_threads(), [&](std::size_t i) {
+        chunks[i] = parse_chunk(bounds[i], bounds[i + 1], sep, column);
+    });
+
+    std::size_t size{};
+    for (const auto& chunk : chunks) {
+        if (chunk.badLine) {
+            const auto line = std::count(first, chunk.badLine, '\n') + 1;
+            throw std::runtime_error{ path + ":" + std::to_string(line) + ": no number in column "
+                                      + std::to_string(column) };
+        }
+        size += chunk.values.size();
+    }
+    if (!size)
+        throw std::runtime_error{ path + " contains no values" };
+
+    List list;
+    list.reserve(size);
+    for (const auto& chunk : chunks)
+        list.insert(end(list), cbegin(chunk.values), cend(chunk.values));
+    return list;
+}
+
+List import_binary(const std::string& path)
+{
+    const MappedFile file{ path };
+    if (!file.size() || file.size() % sizeof(double))
+        throw std::runtime_error{ path + " is not an array of doubles" };
+
+    const auto swap = !host_is_little_endian();
+    List list(file.size() / sizeof(double));
+    for (std::size_t i = 0; i < list.size(); ++i) {
+        std::uint64_t bits;
+        std::memcpy(&bits, file.data() + i * sizeof bits, sizeof bits);
+        if (swap)
+            bits = byteswap(bits);
+        double value;
+        std::memcpy(&value, &bits, sizeof value);
+        list[i] = value;
+    }
+    return list;
+}
+
+List import_list(const std::string& path, std::size_t column)
+{
+    const auto dot = path.rfind('.');
+    if (dot != std::string::npos && path.compare(dot, std::string::npos, ".bin") == 0)
+        return import_binary(path);
+    return import_csv(path, column);
+}
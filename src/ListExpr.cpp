@@ -0,0 +1,421 @@
+#include "ListExpr.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+
+#include "linalg.hpp"
+#include "math_util.hpp"
+
+namespace {
+
+class ListLeaf : public ListExpr {
+public:
+    ListLeaf(ListView view, std::shared_ptr<const void> owner, bool sorted) noexcept
+        : ListExpr{ view.size() }, owner{ std::move(owner) }, view{ view }, sorted{ sorted } { }
+
+    const Complex* eval(std::size_t first, std::size_t, Complex*) const override { return view.data() + first; }
+    const Complex* data() const noexcept override { return view.data(); }
+    bool reads_from(ListView list) const noexcept override
+    {
+        return view.data() < list.end() && list.data() < view.end();
+    }
+    bool is_sorted() const noexcept override { return sorted; }
+
+private:
+    std::shared_ptr<const void> owner;  // keeps the elements alive, e.g. when their list is redefined
+    ListView view;
+    bool sorted;
+};
+
+class Broadcast : public ListExpr {  // a number standing in for every element
+public:
+    Broadcast(const Complex& num, std::size_t size) noexcept
+        : ListExpr{ size }, num{ num } { }
+
+    const Complex* eval(std::size_t, std::size_t n, Complex* scratch) const override
+    {
+        std::fill_n(scratch, n, num);
+        return scratch;
+    }
+
+private:
+    Complex num;
+};
+
+// Kernels on the interleaved real and imaginary parts, which the compiler vectorizes
+void add(const Complex* a, const Complex* b, Complex* out, std::size_t n) noexcept
+{
+    const auto x = reinterpret_cast<const double*>(a);
+    const auto y = reinterpret_cast<const double*>(b);
+    const auto z = reinterpret_cast<double*>(out);
+    for (std::size_t i = 0; i < 2 * n; ++i)
+        z[i] = x[i] + y[i];
+}
+
+void sub(const Complex* a, const Complex* b, Complex* out, std::size_t n) noexcept
+{
+    const auto x = reinterpret_cast<const double*>(a);
+    const auto y = reinterpret_cast<const double*>(b);
+    const auto z = reinterpret_cast<double*>(out);
+    for (std::size_t i = 0; i < 2 * n; ++i)
+        z[i] = x[i] - y[i];
+}
+
+void mul(const Complex* a, const Complex* b, Complex* out, std::size_t n) noexcept
+{   // the textbook product, redone with std::complex where it is nan (inf operands),
+    // so every element matches scalar multiplication
+    double re[ListExpr::blockSize], im[ListExpr::blockSize];
+    const auto x = reinterpret_cast<const double*>(a);
+    const auto y = reinterpret_cast<const double*>(b);
+    for (std::size_t i = 0; i < n; ++i) {
+        re[i] = x[2 * i] * y[2 * i] - x[2 * i + 1] * y[2 * i + 1];
+        im[i] = x[2 * i] * y[2 * i + 1] + x[2 * i + 1] * y[2 * i];
+    }
+    for (std::size_t i = 0; i < n; ++i)
+        out[i] = std::isnan(re[i]) && std::isnan(im[i]) ? a[i] * b[i] : Complex{ re[i], im[i] };
+}
+
+class Binary : public ListExpr {
+public:
+    Binary(ElemOp op, ListExprPtr left, ListExprPtr right) noexcept
+        : ListExpr{ left->size() }, op{ op }, left{ std::move(left) }, right{ std::move(right) } { }
+
+    const Complex* eval(std::size_t first, std::size_t n, Complex* scratch) const override
+    {
+        alignas(Complex) double rhs[2 * blockSize];  // uninitialized, unlike Complex[]
+        const auto a = left->eval(first, n, scratch);
+        const auto b = right->eval(first, n, reinterpret_cast<Complex*>(rhs));
+        switch (op) {
+        case ElemOp::Add:
+            add(a, b, scratch, n);
+            break;
+        case ElemOp::Sub:
+            sub(a, b, scratch, n);
+            break;
+        case ElemOp::Mul:
+            mul(a, b, scratch, n);
+            break;
+        default:
+            for (std::size_t i = 0; i < n; ++i)
+                scratch[i] = apply(op, a[i], b[i]);
+        }
+        return scratch;
+    }
+
+    bool reads_from(ListView list) const noexcept override
+    {
+        return left->reads_from(list) || right->reads_from(list);
+    }
+
+private:
+    ElemOp op;
+    ListExprPtr left;
+    ListExprPtr right;
+};
+
+class Unary : public ListExpr {
+public:
+    Unary(UnaryOp op, ListExprPtr operand) noexcept
+        : ListExpr{ operand->size() }, op{ op }, operand{ std::move(operand) } { }
+
+    const Complex* eval(std::size_t first, std::size_t n, Complex* scratch) const override
+    {
+        const auto a = operand->eval(first, n, scratch);
+        if (op == UnaryOp::Neg) {
+            for (std::size_t i = 0; i < n; ++i)
+                scratch[i] = -a[i];
+        }
+        else {
+            for (std::size_t i = 0; i < n; ++i)
+                scratch[i] = factorial(a[i]);
+        }
+        return scratch;
+    }
+
+    bool reads_from(ListView list) const noexcept override { return operand->reads_from(list); }
+
+private:
+    UnaryOp op;
+    ListExprPtr operand;
+};
+
+class Mapped : public ListExpr {
+public:
+    Mapped(ElementFunc f, ListExprPtr operand) noexcept
+        : ListExpr{ operand->size() }, f{ f }, operand{ std::move(operand) } { }
+
+    const Complex* eval(std::size_t first, std::size_t n, Complex* scratch) const override
+    {
+        f(operand->eval(first, n, scratch), scratch, n);
+        return scratch;
+    }
+
+    bool reads_from(ListView list) const noexcept override { return operand->reads_from(list); }
+
+private:
+    ElementFunc f;
+    ListExprPtr operand;
+};
+
+class MappedMany : public ListExpr {
+public:
+    MappedMany(std::shared_ptr<const BlockFunction> f, std::vector<ListExprPtr> args) noexcept
+        : ListExpr{ args.front()->size() }, f{ std::move(f) }, args{ std::move(args) } { }
+
+    const Complex* eval(std::size_t first, std::size_t n, Complex* scratch) const override
+    {   // every argument needs its own block, on the stack for the usual few
+        constexpr std::size_t stackArgs{ 4 };
+        alignas(Complex) double local[2 * stackArgs * blockSize];  // uninitialized, unlike Complex[]
+        std::unique_ptr<double[]> heap;
+        auto blocks = reinterpret_cast<Complex*>(local);
+        if (args.size() > stackArgs) {
+            heap.reset(new double[2 * args.size() * blockSize]);
+            blocks = reinterpret_cast<Complex*>(heap.get());
+        }
+        const Complex* argBlocks[stackArgs];
+        std::vector<const Complex*> manyBlocks(args.size() > stackArgs ? args.size() : 0);
+        const auto ptrs = manyBlocks.empty() ? argBlocks : manyBlocks.data();
+        for (std::size_t i = 0; i < args.size(); ++i)
+            ptrs[i] = args[i]->eval(first, n, blocks + i * blockSize);
+        f->eval(ptrs, args.size(), scratch, n);
+        return scratch;
+    }
+
+    bool reads_from(ListView list) const noexcept override
+    {
+        return std::any_of(begin(args), end(args), [&](const ListExprPtr& arg) { return arg->reads_from(list); });
+    }
+
+private:
+    std::shared_ptr<const BlockFunction> f;
+    std::vector<ListExprPtr> args;
+};
+
+class Slice : public ListExpr {
+public:
+    Slice(ListExprPtr list, std::size_t start, std::ptrdiff_t step, std::size_t count) noexcept
+        : ListExpr{ count }, list{ std::move(list) }, start{ start }, step{ step } { }
+
+    const Complex* eval(std::size_t first, std::size_t n, Complex* scratch) const override
+    {
+        if (step == 1)
+            return list->eval(start + first, n, scratch);
+        const auto index = [&](std::size_t i) { return start + static_cast<std::ptrdiff_t>(first + i) * step; };
+        if (const auto data = list->data()) {
+            for (std::size_t i = 0; i < n; ++i)
+                scratch[i] = data[index(i)];
+        }
+        else {
+            for (std::size_t i = 0; i < n; ++i)
+                scratch[i] = element(*list, index(i));
+        }
+        return scratch;
+    }
+
+    const Complex* data() const noexcept override
+    {
+        const auto data = list->data();
+        return step == 1 && data ? data + start : nullptr;
+    }
+
+    bool reads_from(ListView l) const noexcept override { return list->reads_from(l); }
+    bool is_sorted() const noexcept override { return step > 0 && list->is_sorted(); }
+
+private:
+    ListExprPtr list;
+    std::size_t start;
+    std::ptrdiff_t step;
+};
+
+void eval_into(const ListExpr& expr, std::size_t first, std::size_t n, Complex* out)
+{
+    for (std::size_t done = 0; done < n; done += ListExpr::blockSize) {
+        const auto block = std::min(ListExpr::blockSize, n - done);
+        const auto elems = expr.eval(first + done, block, out + done);
+        if (elems != out + done)
+            std::copy_n(elems, block, out + done);
+    }
+}
+
+Value apply_matrix(ElemOp op, const Value& left, const Value& right)
+{
+    if (left.is_matrix() && right.is_matrix()) {
+        switch (op) {
+        case ElemOp::Add:
+            return add(*left.matrix(), *right.matrix());
+        case ElemOp::Sub:
+            return sub(*left.matrix(), *right.matrix());
+        case ElemOp::Mul:
+            return multiply(*left.matrix(), *right.matrix());
+        case ElemOp::Div:
+            throw std::runtime_error{ "Use solve or inv to divide by a matrix" };
+        default:
+            break;
+        }
+    }
+    else if (left.is_matrix() && right.is_list()) {
+        if (op == ElemOp::Mul)
+            return list_value(multiply(*left.matrix(), to_list(*right.list())));
+    }
+    else if (left.is_matrix() && !right.is_list()) {
+        const auto& exp = right.num();
+        switch (op) {
+        case ElemOp::Mul:
+            return scale(*left.matrix(), exp);
+        case ElemOp::Div:
+            return scale(*left.matrix(), safe_div(1, exp));
+        case ElemOp::Pow:
+        case ElemOp::LiteralPow:
+            if (exp.imag() || exp.real() != std::trunc(exp.real()) || std::abs(exp.real()) > 1e18)
+                throw std::runtime_error{ "Matrices can only be raised to integer powers" };
+            return matrix_pow(*left.matrix(), static_cast<std::int64_t>(exp.real()));
+        default:
+            break;
+        }
+    }
+    else if (!left.is_list() && op == ElemOp::Mul)
+        return scale(*right.matrix(), left.num());
+    throw std::runtime_error{ "Operation not defined for these matrix operands" };
+}
+
+ListExprPtr as_list(const Value& val, std::size_t size)
+{
+    return val.is_list() ? val.list() : std::make_shared<const Broadcast>(val.num(), size);
+}
+
+}   // anonymous namespace
+
+Complex apply(ElemOp op, const Complex& left, const Complex& right)
+{
+    switch (op) {
+    case ElemOp::Add:
+        return left + right;
+    case ElemOp::Sub:
+        return left - right;
+    case ElemOp::Mul:
+        return left * right;
+    case ElemOp::Div:
+        return safe_div(left, right);
+    case ElemOp::FloorDiv:
+        return safe_floordiv(left, right);
+    case ElemOp::Mod:
+        return safe_mod(left, right);
+    case ElemOp::Parallel:
+        return impedance_parallel(left, right);
+    case ElemOp::Pow:
+        return pretty_pow(left, right);
+    case ElemOp::LiteralPow:
+        return literal_pow(left, right.real());
+    }
+    throw std::logic_error{ "Unknown element-wise operation" };
+}
+
+Value apply(ElemOp op, const Value& left, const Value& right)
+{
+    if (left.is_matrix() || right.is_matrix())
+        return apply_matrix(op, left, right);
+    if (!left.is_list() && !right.is_list())
+        return apply(op, left.num(), right.num());
+
+    if (left.is_list() && right.is_list() && left.list()->size() != right.list()->size())
+        throw std::runtime_error{ "Lists differ in length (" + std::to_string(left.list()->size()) + " and "
+                                  + std::to_string(right.list()->size()) + ")" };
+    const auto size = left.is_list() ? left.list()->size() : right.list()->size();
+    return ListExprPtr{ std::make_shared<const Binary>(op, as_list(left, size), as_list(right, size)) };
+}
+
+Value apply(UnaryOp op, const Value& operand)
+{
+    if (operand.is_matrix()) {
+        if (op == UnaryOp::Neg)
+            return scale(*operand.matrix(), -1);
+        throw std::runtime_error{ "Factorial not defined for matrices" };
+    }
+    if (operand.is_list())
+        return ListExprPtr{ std::make_shared<const Unary>(op, operand.list()) };
+    return op == UnaryOp::Neg ? -operand.num() : factorial(operand.num());
+}
+
+Value map_elements(ElementFunc f, const ListExprPtr& list)
+{
+    return ListExprPtr{ std::make_shared<const Mapped>(f, list) };
+}
+
+Value map_elements(std::shared_ptr<const BlockFunction> f, const std::vector<Value>& args)
+{
+    const auto first = std::find_if(begin(args), end(args), [](const Value& arg) { return arg.is_list(); });
+    if (first == end(args))
+        throw std::runtime_error{ "No list argument to map over" };
+    const auto size = first->list()->size();
+    std::vector<ListExprPtr> lists;
+    lists.reserve(args.size());
+    for (const auto& arg : args) {
+        if (arg.is_matrix())
+            throw std::runtime_error{ "Expected a number, not a matrix" };
+        if (arg.is_list() && arg.list()->size() != size)
+            throw std::runtime_error{ "Lists differ in length (" + std::to_string(size) + " and "
+                                      + std::to_string(arg.list()->size()) + ")" };
+        lists.push_back(as_list(arg, size));
+    }
+    return ListExprPtr{ std::make_shared<const MappedMany>(std::move(f), std::move(lists)) };
+}
+
+Value list_value(ListView view, bool sorted)
+{
+    return list_value(view, nullptr, sorted);
+}
+
+Value list_value(ListView view, std::shared_ptr<const void> owner, bool sorted)
+{
+    return ListExprPtr{ std::make_shared<const ListLeaf>(view, std::move(owner), sorted) };
+}
+
+Value list_value(List&& list, bool sorted)
+{
+    auto owned = std::make_shared<const List>(std::move(list));
+    const ListView view{ *owned };
+    return list_value(view, std::move(owned), sorted);
+}
+
+Value slice(const ListExprPtr& list, std::size_t first, std::ptrdiff_t step, std::size_t count)
+{
+    return ListExprPtr{ std::make_shared<const Slice>(list, first, step, count) };
+}
+
+Complex element(const ListExpr& list, std::size_t i)
+{
+    if (const auto data = list.data())
+        return data[i];
+    Complex scratch;
+    return *list.eval(i, 1, &scratch);
+}
+
+List to_list(const ListExpr& expr)
+{
+    if (const auto data = expr.data())
+        return { data, data + expr.size() };
+    List list;  // appended block by block, List(size) would write every element twice
+    list.reserve(expr.size());
+    Complex block[ListExpr::blockSize];
+    for (std::size_t first = 0; first < expr.size(); first += ListExpr::blockSize) {
+        const auto n = std::min(ListExpr::blockSize, expr.size() - first);
+        const auto elems = expr.eval(first, n, block);
+        list.insert(end(list), elems, elems + n);
+    }
+    return list;
+}
+
+void eval_to(const ListExpr& expr, Complex* out)
+{
+    eval_into(expr, 0, expr.size(), out);
+}
+
+std::size_t ListExprStream::read(Complex* out, std::size_t max)
+{
+    const auto n = std::min(max, expr->size() - pos);
+    eval_into(*expr, pos, n, out);
+    pos += n;
+    return n;
+}
@@ -0,0 +1,40 @@
+#include "ListRange.hpp"
+
+#include <stdexcept>
+
+ListRange::ListRange(double start, double end, double step, Function term)
+    : start{ start }, step{ step }, term{ std::move(term) }, next{ start }
+{
+    if (start < end && step > 0) {
+        for (auto i = start; i <= end; i += step)
+            ++count;
+    }
+    else if (start > end && step < 0) {
+        for (auto i = start; i >= end; i += step)
+            ++count;
+    }
+    else
+        throw std::runtime_error{ "Infinite loop" };
+}
+
+void ListRange::restart()
+{
+    next = start;
+    pos = 0;
+}
+
+std::size_t ListRange::read(Complex* out, std::size_t max)
+{
+    std::size_t n{};
+    for (; n < max && pos < count; ++n, ++pos, next += step)
+        out[n] = term({ Complex(next) });
+    return n;
+}
+
+List ListRange::to_list()
+{
+    List list(count);
+    restart();
+    read(list.data(), list.size());
+    return list;
+}
@@ -0,0 +1,118 @@
+#include "MappedFile.hpp"
+
+#include <stdexcept>
+#include <utility>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+
+MappedFile::MappedFile(const std::string& path, MapMode mode)
+    : writable{ mode == MapMode::CopyOnWrite }
+{
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                              OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+        throw std::runtime_error{ "Cannot open file " + path };
+
+    LARGE_INTEGER size{};
+    if (!GetFileSizeEx(file, &size)) {
+        CloseHandle(file);
+        throw std::runtime_error{ "Cannot read size of " + path };
+    }
+    length = static_cast<std::size_t>(size.QuadPart);
+    if (!length) {
+        CloseHandle(file);
+        return;
+    }
+
+    HANDLE mapping = CreateFileMappingA(file, nullptr, writable ? PAGE_WRITECOPY : PAGE_READONLY, 0, 0, nullptr);
+    CloseHandle(file);
+    if (!mapping)
+        throw std::runtime_error{ "Cannot map " + path };
+
+    // the view keeps its own reference to the mapping object
+    first = static_cast<char*>(MapViewOfFile(mapping, writable ? FILE_MAP_COPY : FILE_MAP_READ, 0, 0, 0));
+    CloseHandle(mapping);
+    if (!first)
+        throw std::runtime_error{ "Cannot map " + path };
+}
+
+void MappedFile::unmap() noexcept
+{
+    if (first)
+        UnmapViewOfFile(first);
+    first = nullptr;
+    length = 0;
+}
+
+#else
+
+MappedFile::MappedFile(const std::string& path, MapMode mode)
+    : writable{ mode == MapMode::CopyOnWrite }
+{
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        throw std::runtime_error{ "Cannot open file " + path };
+
+    struct stat info{};
+    if (::fstat(fd, &info) < 0) {
+        ::close(fd);
+        throw std::runtime_error{ "Cannot read size of " + path };
+    }
+    length = static_cast<std::size_t>(info.st_size);
+    if (!length) {
+        ::close(fd);
+        return;
+    }
+
+    void* addr = writable ? ::mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0)
+                          : ::mmap(nullptr, length, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);  // the mapping stays valid after closing the descriptor
+    if (addr == MAP_FAILED) {
+        length = 0;
+        throw std::runtime_error{ "Cannot map " + path };
+    }
+    first = static_cast<char*>(addr);
+}
+
+void MappedFile::unmap() noexcept
+{
+    if (first)
+        ::munmap(first, length);
+    first = nullptr;
+    length = 0;
+}
+
+#endif  /* _WIN32 */
+
+MappedFile::~MappedFile()
+{
+    unmap();
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+    : first{ std::exchange(other.first, nullptr) },
+      length{ std::exchange(other.length, 0) },
+      writable{ std::exchange(other.writable, false) }
+{
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept
+{
+    if (this != &other) {
+        unmap();
+        first = std::exchange(other.first, nullptr);
+        length = std::exchange(other.length, 0);
+        writable = std::exchange(other.writable, false);
+    }
+    return *this;
+}
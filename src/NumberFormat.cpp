@@ -0,0 +1,118 @@
+#include "NumberFormat.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+
+void format_real(std::string& out, double num, int precision)
+{   // chars_format::general with a precision matches printf's %g, which is what
+    // operator<< uses for doubles, so the default output stays byte-identical
+    char tmp[128];
+    const auto res = precision > 0
+        ? std::to_chars(tmp, tmp + sizeof tmp, num, std::chars_format::general, std::min(precision, 100))
+        : std::to_chars(tmp, tmp + sizeof tmp, num);
+    out.append(tmp, res.ptr);
+}
+
+void format_complex(std::string& out, const Complex& n, int precision)
+{   // keep in sync with print_complex
+    if (n.imag()) {
+        if (n.real()) {
+            format_real(out, n.real(), precision);
+            if (n.imag() > 0)
+                out += '+';
+        }
+        if (std::abs(n.imag()) != 1)
+            format_real(out, n.imag(), precision);
+        if (n.imag() == -1)
+            out += '-';
+        out += 'i';
+    }
+    else
+        format_real(out, n.real(), precision);
+}
+
+void format_list(std::string& out, ListView list, int precision)
+{
+    out += '[';
+    const char* sep = "";
+    for (const auto& item : list) {
+        out += sep;
+        format_complex(out, item, precision);
+        sep = ", ";
+    }
+    out += ']';
+}
+
+void format_matrix(std::string& out, const Matrix& matrix, int precision)
+{
+    out += '[';
+    for (std::size_t i = 0; i < matrix.rows(); ++i) {
+        if (i)
+            out += "; ";
+        for (std::size_t j = 0; j < matrix.cols(); ++j) {
+            if (j)
+                out += ", ";
+            format_complex(out, matrix(i, j), precision);
+        }
+    }
+    out += ']';
+}
+
+OutputBuffer::OutputBuffer(std::ostream& os, std::size_t capacity)
+    : os{ os }, capacity{ capacity }
+{
+    buf.reserve(capacity);
+}
+
+OutputBuffer::~OutputBuffer()
+{
+    flush();
+}
+
+void OutputBuffer::write(const Complex& num)
+{
+    format_complex(buf, num, precision);
+    flush_if_full();
+}
+
+void OutputBuffer::write(ListView list)
+{
+    format_list(buf, list, precision);
+    flush_if_full();
+}
+
+void OutputBuffer::write(const Matrix& matrix)
+{
+    format_matrix(buf, matrix, precision);
+    flush_if_full();
+}
+
+void OutputBuffer::write(const std::string& str)
+{
+    buf += str;
+    flush_if_full();
+}
+
+void OutputBuffer::write(char ch)
+{
+    buf += ch;
+    flush_if_full();
+}
+
+void OutputBuffer::flush()
+{
+    if (buf.size()) {
+        os.write(buf.data(), static_cast<std::streamsize>(buf.size()));
+        buf.clear();
+    }
+    os.flush();
+}
+
+void OutputBuffer::flush_if_full()
+{
+    if (buf.size() >= capacity) {
+        os.write(buf.data(), static_cast<std::streamsize>(buf.size()));
+        buf.clear();
+    }
+}
@@ -0,0 +1,166 @@
+#include "OrderStatistics.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+#include "parallel.hpp"
+
+namespace {
+
+constexpr std::size_t blockSize{ 1 << 12 };
+
+bool real_less(const Complex& left, const Complex& right) noexcept
+{
+    return left.real() < right.real();
+}
+
+void check_real(const Complex* first, const Complex* last)
+{   // nan would break the strict weak ordering the standard algorithms rely on
+    for (; first != last; ++first) {
+        if (first->imag() != 0)
+            throw std::runtime_error{ "Complex numbers have no order" };
+        if (std::isnan(first->real()))
+            throw std::runtime_error{ "NaN has no order" };
+    }
+}
+
+void check_not_empty(const ListSource& list)
+{
+    if (!list.size())
+        throw std::runtime_error{ "Invalid empty list" };
+}
+
+// All elements in a list of our own, which may be reordered
+List elements(ListSource list)
+{
+    List elems;
+    if (const auto stream = list.as_stream()) {
+        elems.resize(stream->size());
+        stream->restart();
+        for (std::size_t n = 0; n < elems.size(); ) {
+            const auto read = stream->read(elems.data() + n, elems.size() - n);
+            if (!read)
+                break;
+            n += read;
+        }
+    }
+    else
+        elems = list.view().to_list();
+    check_real(elems.data(), elems.data() + elems.size());
+    return elems;
+}
+
+template<class Better>
+Complex extreme(ListSource list, Better better)
+{
+    check_not_empty(list);
+    Complex res;
+    bool first{ true };
+    const auto scan = [&](const Complex* elems, std::size_t n) {
+        check_real(elems, elems + n);
+        for (std::size_t i = 0; i < n; ++i) {
+            if (first || better(elems[i].real(), res.real()))
+                res = elems[i];
+            first = false;
+        }
+    };
+    if (const auto stream = list.as_stream()) {
+        std::vector<Complex> block(blockSize);
+        stream->restart();
+        for (std::size_t n; (n = stream->read(block.data(), block.size())); )
+            scan(block.data(), n);
+    }
+    else
+        scan(list.view().data(), list.size());
+    return res;
+}
+
+// p-th percentile of elems, which are sorted if `sorted`, otherwise reordered
+Complex rank_value(List& elems, double p, bool sorted)
+{
+    const auto rank = p / 100 * static_cast<double>(elems.size() - 1);
+    const auto lower = static_cast<std::size_t>(rank);
+    const auto frac = rank - static_cast<double>(lower);
+    const auto lo = begin(elems) + static_cast<std::ptrdiff_t>(lower);
+    if (!sorted)
+        std::nth_element(begin(elems), lo, end(elems), real_less);
+    if (!frac)
+        return *lo;
+    // the next rank is the smallest element above the lower one
+    const auto hi = sorted ? std::next(lo) : std::min_element(std::next(lo), end(elems), real_less);
+    return lo->real() + frac * (hi->real() - lo->real());
+}
+
+}   // anonymous namespace
+
+Complex list_min(ListSource list, const ReduceOptions&)
+{
+    if (list.is_sorted() && !list.as_stream() && list.size())
+        return list.view().front();
+    return extreme(list, [](double x, double best) { return x < best; });
+}
+
+Complex list_max(ListSource list, const ReduceOptions&)
+{
+    if (list.is_sorted() && !list.as_stream() && list.size())
+        return list.view().back();
+    return extreme(list, [](double x, double best) { return x > best; });
+}
+
+Complex median(ListSource list, const ReduceOptions& opts)
+{
+    return percentile(list, 50, opts);
+}
+
+Complex percentile(ListSource list, double p, const ReduceOptions&)
+{
+    if (!(p >= 0 && p <= 100))
+        throw std::runtime_error{ "Percentiles range from 0 to 100" };
+    check_not_empty(list);
+
+    if (list.is_sorted() && !list.as_stream()) {  // no copy needed
+        const auto view = list.view();
+        const auto rank = p / 100 * static_cast<double>(view.size() - 1);
+        const auto lower = static_cast<std::size_t>(rank);
+        const auto frac = rank - static_cast<double>(lower);
+        if (!frac)
+            return view[lower];
+        return view[lower].real() + frac * (view[lower + 1].real() - view[lower].real());
+    }
+    auto elems = elements(list);
+    return rank_value(elems, p, list.is_sorted());
+}
+
+List sorted(ListSource list, const ReduceOptions& opts)
+{
+    auto elems = elements(list);
+    if (list.is_sorted())
+        return elems;
+
+    const auto n = elems.size();
+    const auto threads = opts.threads ? opts.threads : hardware_threads();
+    if (n < opts.parallelThreshold || threads < 2) {
+        std::sort(begin(elems), end(elems), real_less);
+        return elems;
+    }
+
+    // sort one chunk per thread, then merge neighbours until a single run is left
+    std::vector<std::size_t> bounds;
+    for (std::size_t t = 0; t <= threads; ++t)
+        bounds.push_back(n * t / threads);
+    parallel_for(threads, threads, [&](std::size_t t) {
+        std::sort(begin(elems) + bounds[t], begin(elems) + bounds[t + 1], real_less);
+    });
+    for (std::size_t width = 1; width < threads; width *= 2) {
+        const auto merges = (threads + 2 * width - 1) / (2 * width);
+        parallel_for(merges, threads, [&](std::size_t m) {
+            const auto first = bounds[std::min<std::size_t>(2 * width * m, threads)];
+            const auto middle = bounds[std::min<std::size_t>(2 * width * m + width, threads)];
+            const auto last = bounds[std::min<std::size_t>(2 * width * (m + 1), threads)];
+            std::inplace_merge(begin(elems) + first, begin(elems) + middle, begin(elems) + last, real_less);
+        });
+    }
+    return elems;
+}
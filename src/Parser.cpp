@@ -1,13 +1,33 @@
 #include "Parser.hpp"
 
+#include <algorithm>
 #include <cmath>
 #include <iostream>
+#include <optional>
 
 #include "mps/stream_util.hpp"
 
 #include "math_util.hpp"
 #include "SymbolTable.hpp"
 
+// Calls f with a source of the list's elements: stored ones in place (they may be
+// mapped from a file), others evaluated block by block without storing them
+template<class F>
+static auto with_source(const ListExprPtr& list, F f)
+{
+    if (const auto data = list->data())
+        return f(ListSource{ ListView{ data, list->size() }, list->is_sorted() });
+    ListExprStream stream{ list };
+    return f(ListSource{ stream, list->is_sorted() });
+}
+
+// Pops the arguments of a call from the evaluation stack, also when the call throws
+struct StackFrame {
+    std::vector<Complex>& stack;
+    std::size_t base;
+    ~StackFrame() { stack.resize(base); }
+};
+
 Parser::Parser(SymbolTable& table)
     : table{ table }  { }
 
@@ -28,6 +48,20 @@ void Parser::parse(const std::string& str)
     parse();
 }
 
+void Parser::append(const std::string& list, const std::string& input)
+{
+    if (table.isset(list) && !table.has_list(list))
+        error(list, " is already defined");
+    ts.set_input(input);
+    ts.get();
+    const auto val = expr();
+    expect(Kind::End);
+    if (val.is_list())
+        table.append_list(list, *val.list());
+    else
+        table.append_list(list, *list_value(List{ val.num() }).list());
+}
+
 void Parser::parse()
 {
     ts.get();
@@ -42,8 +76,19 @@ void Parser::stmt()
         func_def();
     else if (peek(Kind::Delete))
         deletion();
-    else if (!peek(Kind::Print))
-        res = expr();
+    else if (!peek(Kind::Print)) {
+        const auto val = expr();
+        if (val.is_list()) {
+            list_result(*val.list());
+            hasResult = false;
+        }
+        else if (val.is_matrix()) {
+            matrix_result(*val.matrix());
+            hasResult = false;
+        }
+        else
+            res = val.num();
+    }
 
     if (hasResult && onRes)
         onRes(res);
@@ -78,13 +123,15 @@ void Parser::parse_param_list(Function& func)
 }
 
 void Parser::parse_func_term(Function& func)
-{
-    std::ostringstream term;
-    while (!peek(Kind::Print) && !peek(Kind::End) && !peek(Kind::RBracket)) {
-        term << ts.current();
-        ts.get();
+{   // the term is kept as written, so literals keep their full precision
+    ts.start_capture();
+    for (int depth = 0; !(depth == 0 && (peek(Kind::Print) || peek(Kind::RBracket))) && !peek(Kind::End); ts.get()) {
+        if (peek(Kind::LBracket))
+            ++depth;
+        else if (peek(Kind::RBracket))
+            --depth;
     }
-    func.set_term(term.str());
+    func.set_term(ts.end_capture());
 }
 
 void Parser::deletion()
@@ -109,173 +156,382 @@ void Parser::del_symbol()
     table.remove_symbol(name);
 }
 
-void Parser::list_def(const std::string& name)
+void Parser::list_result(const ListExpr& list)
+{
+    if (const auto data = list.data())
+        print_list_result({ data, list.size() });
+    else
+        print_list_result(to_list(list));
+}
+
+void Parser::print_list_result(ListView list)
+{
+    if (onListRes)
+        onListRes(list);
+    else {
+        print_list(std::cout, list);
+        std::cout << '\n';
+    }
+}
+
+void Parser::matrix_result(const Matrix& matrix)
 {
-    table.set_list(name, list());
+    if (onMatrixRes)
+        onMatrixRes(matrix);
+    else {
+        print_matrix(std::cout, matrix);
+        std::cout << '\n';
+    }
 }
 
-Complex Parser::expr()
+Value Parser::expr()
 {
     auto left = term();
     for (;;) {
         if (consume(Kind::Plus)) 
-            left += term();
+            left = apply(ElemOp::Add, left, term());
         else if (consume(Kind::Minus)) 
-            left -= term();
+            left = apply(ElemOp::Sub, left, term());
         else
             return left;
     }
 }
 
-Complex Parser::term()
+Value Parser::term()
 {
     auto left = sign();
     for (;;) {
         if (consume(Kind::Mul))
-            left *= sign();
+            left = apply(ElemOp::Mul, left, sign());
         else if (consume(Kind::Div))
-            left = safe_div(left, sign());
+            left = apply(ElemOp::Div, left, sign());
         else if (consume(Kind::FloorDiv))
-            left = safe_floordiv(left, sign());
+            left = apply(ElemOp::FloorDiv, left, sign());
         else if (consume(Kind::Mod))
-            left = safe_mod(left, sign());
+            left = apply(ElemOp::Mod, left, sign());
         else if (consume(Kind::Parallel))
-            left = impedance_parallel(left, sign());
+            left = apply(ElemOp::Parallel, left, sign());
         else 
             return left;
     }
 }
 
-Complex Parser::sign()
+Value Parser::sign()
 {
     if (consume(Kind::Minus)) 
-        return -postfix();
+        return apply(UnaryOp::Neg, postfix());
     consume(Kind::Plus);
     return postfix();
 }
 
-Complex Parser::postfix()
+Value Parser::postfix()
 {
     auto left = prim();
     for (;;) {
-        if (consume(Kind::Pow))
-            return pretty_pow(left, sign());
+        if (consume(Kind::Pow)) {
+            if (literal_exponent())
+                return apply(ElemOp::LiteralPow, left, ts.previous().num);
+            return apply(ElemOp::Pow, left, sign());
+        }
         else if (peek(Kind::String))
-            return left * postfix();
+            return apply(ElemOp::Mul, left, postfix());
         else if (peek(Kind::LParen))
-            return left * prim();
+            return apply(ElemOp::Mul, left, prim());
         else if (consume(Kind::Fac))
-            left = factorial(left);
+            left = apply(UnaryOp::Fac, left);
+        else if (peek(Kind::LBracket))
+            left = subscript(left);
         else
             return left;
     }
 }
 
-Complex Parser::prim()
+bool Parser::literal_exponent()
+{   // a number is the whole exponent unless something binding tighter follows (2^3!, 2^3x, 2^3^2)
+    if (!peek(Kind::Number))
+        return false;
+    switch (ts.peek(1).kind) {
+    case Kind::Pow:
+    case Kind::Fac:
+    case Kind::String:
+    case Kind::LParen:
+    case Kind::Number:
+        return false;
+    default:
+        ts.get();
+        return true;
+    }
+}
+
+Value Parser::prim()
 {
     if (consume(Kind::Number)) 
-        return prevTok.num;
+        return ts.previous().num;
     if (peek(Kind::String))
         return resolve_str_tok();
+    if (peek(Kind::LBracket))
+        return list();
     if (consume(Kind::LParen)) {
         auto val = expr();
         expect(Kind::RParen);
         return val;
     }
     error("Unexpected Token ", ts.current());
-    throw std::logic_error{ "Fall through prim()" }; // silence C4715
 }
 
-Complex Parser::resolve_str_tok()
+Value Parser::subscript(const Value& val)
+{   // list[i] or list[start:stop:step], indices count from 0 and negative ones from the end
+    expect(Kind::LBracket);
+    if (!val.is_list())
+        error("Only lists can be indexed");
+    const auto& list = val.list();
+    const auto size = static_cast<std::ptrdiff_t>(list->size());
+
+    const auto start = peek(Kind::Colon) ? std::optional<std::ptrdiff_t>{} : index();
+    if (consume(Kind::RBracket)) {
+        const auto i = *start < 0 ? *start + size : *start;
+        if (i < 0 || i >= size)
+            error("Index ", *start, " is out of range for ", size, " elements");
+        return element(*list, static_cast<std::size_t>(i));
+    }
+
+    expect(Kind::Colon);
+    const auto stop = peek(Kind::Colon) || peek(Kind::RBracket) ? std::optional<std::ptrdiff_t>{} : index();
+    std::ptrdiff_t step{ 1 };
+    if (consume(Kind::Colon) && !peek(Kind::RBracket))
+        step = index();
+    expect(Kind::RBracket);
+    if (!step)
+        error("Slice step cannot be 0");
+
+    // clamped like Python slices; with a negative step the slice runs from start down to stop + 1
+    const auto lo = step > 0 ? std::ptrdiff_t{ 0 } : std::ptrdiff_t{ -1 };
+    const auto hi = step > 0 ? size : size - 1;
+    const auto bound = [&](const std::optional<std::ptrdiff_t>& i, std::ptrdiff_t dflt) {
+        return i ? std::clamp(*i < 0 ? *i + size : *i, lo, hi) : dflt;
+    };
+    const auto first = bound(start, step > 0 ? lo : hi);
+    const auto last = bound(stop, step > 0 ? hi : lo);
+    const auto span = step > 0 ? last - first : first - last;
+    const auto count = span > 0 ? (span - 1) / std::abs(step) + 1 : 0;
+    return slice(list, static_cast<std::size_t>(first), step, static_cast<std::size_t>(count));
+}
+
+std::ptrdiff_t Parser::index()
 {
-    const auto name = ident();
-    if (peek(Kind::LParen))
-        return table.call_func(name, arg_list());
-    else if (consume(Kind::Assign)) {
-        if (peek(Kind::LBracket)) {
-            list_def(name);
-            return no_result();
+    const auto i = number(expr());
+    if (i.imag() != 0 || i.real() != std::trunc(i.real()) || std::abs(i.real()) > 9e15)
+        error("Indices must be integers");
+    return static_cast<std::ptrdiff_t>(i.real());
+}
+
+Value Parser::resolve_str_tok()
+{
+    const auto& name = ident();
+    if (peek(Kind::LParen)) {  // resolve the callee once, before evaluating its arguments
+        if (const auto f = table.find_func(name))
+            return (*f)(arg_list());
+        if (const auto f = SymbolTable::find_builtin(name))
+            return builtin(name, *f);
+        if (const auto f = table.find_native(name))
+            return native(f);
+        if (const auto r = SymbolTable::find_reduction(name))
+            return reduction(r, name == "len");
+        if (const auto f = SymbolTable::find_list_func(name))
+            return list_func(f);
+        if (const auto f = SymbolTable::find_value_func(name)) {
+            expect(Kind::LParen);
+            const auto args = value_list();
+            expect(Kind::RParen);
+            return f(args);
         }
-        return var_def(name);
+        error("Function ", name, " is undefined");
     }
-    else if (table.has_list(name)) {
-        if (!peek(Kind::Print) && !peek(Kind::End))
-            error("Unexpected Token ", ts.current());
-        print_list(std::cout, table.list(name));
-        std::cout << '\n';
-        return no_result();
+    else if (consume(Kind::Assign)) {
+        const std::string var{ name };
+        return var_def(var);
     }
-    return table.value_of(name);
+    else if (const auto l = table.find_list(name))
+        return list_value(l->view(), l->owner(), l->is_sorted());
+    else if (auto m = table.find_matrix(name))
+        return m;
+    else if (const auto var = table.find_var(name))
+        return var->value;
+    error("Variable ", name, " is undefined");
 }
 
-Complex Parser::var_def(const std::string& name)
+Value Parser::var_def(const std::string& name)
 {
     if (table.is_const(name))
         error("Cannot override constant ", name);
-    if (peek(Kind::LBracket)) {
-        table.set_list(name, list());
+    const auto val = expr();
+    if (val.is_list()) {
+        table.remove_matrix(name);
+        table.set_list(name, *val.list());
+        return no_result();
+    }
+    if (val.is_matrix()) {
+        table.remove_list(name);
+        table.set_matrix(name, val.matrix());
         return no_result();
     }
     if (table.isset(name) && !table.has_var(name))
         error(name, " is already defined");
-    const auto val = expr();
-    table.set_var(name, val);
+    table.set_var(name, val.num());
     return varDefIsRes ? val : no_result();
 }
 
+Value Parser::builtin(const std::string& name, const Builtin& f)
+{   // arguments go on the evaluation stack, so calling with numbers allocates nothing
+    const std::string callee{ name };  // name refers into the token ring
+    const StackFrame frame{ stack, stack.size() };
+
+    expect(Kind::LParen);
+    if (!peek(Kind::RParen)) {
+        do {
+            const auto val = expr();
+            if (!val.is_list())
+                stack.push_back(number(val));
+            else if (stack.size() == frame.base && f.element_func() && peek(Kind::RParen)) {
+                expect(Kind::RParen);  // a lone list is mapped element by element
+                return map_elements(f.element_func(), val.list());
+            }
+            else {  // other lists contribute all their elements
+                const auto elems = to_list(*val.list());
+                stack.insert(end(stack), cbegin(elems), cend(elems));
+            }
+        } while (consume(Kind::Comma));
+    }
+    expect(Kind::RParen);
+
+    const auto n = stack.size() - frame.base;
+    f.check_arity(callee, n);
+    return f(stack.data() + frame.base, n);
+}
+
+Value Parser::native(const std::shared_ptr<const NativeFunction>& f)
+{
+    expect(Kind::LParen);
+    const auto args = value_list();
+    expect(Kind::RParen);
+    f->check_arity(args.size());
+
+    if (std::any_of(cbegin(args), cend(args), [](const Value& arg) { return arg.is_list(); })) {
+        // pure functions join the list expression and run over blocks as it is evaluated;
+        // others run now, exactly once per element and in order
+        const auto mapped = map_elements(f, args);
+        return f->is_pure() ? mapped : list_value(to_list(*mapped.list()));
+    }
+    const StackFrame frame{ stack, stack.size() };
+    for (const auto& arg : args)
+        stack.push_back(number(arg));
+    return (*f)(stack.data() + frame.base, args.size());
+}
+
+Complex Parser::reduction(Reduction r, bool allowEmpty)
+{   // only the length is defined for an empty list
+    if (peek(Kind::LParen) && ts.peek(1).kind == Kind::LBracket && ts.peek(2).kind == Kind::For) {
+        consume(Kind::LParen);  // stream a lone list comprehension straight into the reduction
+        auto range = list_range();
+        expect(Kind::RParen);
+        if (!range.size() && !allowEmpty)
+            error("Invalid empty argument list");
+        return r(range, table.reduce_options());
+    }
+
+    expect(Kind::LParen);
+    const auto args = value_list();
+    expect(Kind::RParen);
+    if (args.size() == 1 && args.front().is_list()) {  // reduce a list expression without storing it
+        if (!args.front().list()->size() && !allowEmpty)
+            error("Invalid empty argument list");
+        return with_source(args.front().list(), [&](ListSource l) { return r(l, table.reduce_options()); });
+    }
+    const auto list = splice(args);
+    if (list.empty() && !allowEmpty)
+        error("Invalid empty argument list");
+    return r(list, table.reduce_options());
+}
+
+Value Parser::list_func(ListFunc f)
+{   // f(list, numbers...)
+    expect(Kind::LParen);
+    const auto list = expr();
+    List params;
+    while (consume(Kind::Comma))
+        params.push_back(number(expr()));
+    expect(Kind::RParen);
+    if (!list.is_list())
+        error("Expected a list as first argument");
+    if (!list.list()->size())
+        error("Invalid empty argument list");
+    return with_source(list.list(), [&](ListSource l) { return f(l, params, table.reduce_options()); });
+}
+
 Complex Parser::no_result()
 {
     hasResult = false;
     return 0; // dummy value
 }
 
-List Parser::list()
-{
+Value Parser::list()
+{   // [1, 2, 3] is a list, rows separated by ; or line breaks make a matrix: [1, 2; 3, 4]
+    if (peek(Kind::LBracket) && ts.peek(1).kind == Kind::For)
+        return list_value(list_range().to_list());
+
     expect(Kind::LBracket);
-    List l;
-    if (consume(Kind::For)) { // [for var=start, end:step loopExpression]
-        auto var = ident();
-        expect(Kind::Assign);
-        double start = prim().real();
-
-        expect(Kind::Comma);
-        double end = prim().real();
-        double step{ 1 };
-        if (consume(Kind::Colon))
-            step = prim().real();
-
-        Function f{ "__internal__", table };
-        f.add_var(var);
-        parse_func_term(f);
-
-		if (start < end && step > 0) {
-			for (auto i = start; i <= end; i += step)
-				l.emplace_back(f({ Complex(i) }));
-		} else if (start > end && step < 0) {
-			for (auto i = start; i >= end; i += step)
-				l.emplace_back(f({ Complex(i) }));
-		} else {
-			error("Infinite loop");
-		}
+    std::vector<List> rows;
+    auto isMatrix = false;
+    for (;;) {
+        if (consume(Kind::Print))
+            isMatrix = true;
+        else if (consume(Kind::RBracket))
+            break;
+        else {
+            rows.push_back(list_elem());
+            if (!peek(Kind::Print) && !peek(Kind::RBracket))
+                expect(Kind::RBracket);
+        }
     }
-    else
-        l = list_elem();
+    if (!isMatrix)
+        return list_value(rows.empty() ? List{} : std::move(rows.front()));
+
+    if (rows.empty() || rows.front().empty())
+        error("Empty matrix");
+    Matrix matrix{ rows.size(), rows.front().size() };
+    for (std::size_t i = 0; i < rows.size(); ++i) {
+        if (rows[i].size() != matrix.cols())
+            error("Matrix rows differ in length (", matrix.cols(), " and ", rows[i].size(), ")");
+        std::copy(cbegin(rows[i]), cend(rows[i]), matrix.row(i));
+    }
+    return matrix;
+}
+
+ListRange Parser::list_range()
+{   // [for var=start, end:step loopExpression]
+    expect(Kind::LBracket);
+    expect(Kind::For);
+    auto var = ident();
+    expect(Kind::Assign);
+    double start = number(prim()).real();
+
+    expect(Kind::Comma);
+    double end = number(prim()).real();
+    double step{ 1 };
+    if (consume(Kind::Colon))
+        step = number(prim()).real();
+
+    Function f{ "__internal__", table };
+    f.add_var(var);
+    parse_func_term(f);
     expect(Kind::RBracket);
-    return l;
+    return { start, end, step, std::move(f) };
 }
 
 List Parser::arg_list()
 {
     expect(Kind::LParen);
-    List args;
-
-    if (peek(Kind::String) && table.has_list(ts.current().str))
-        args = table.list(ident());
-    else if (peek(Kind::LBracket))
-        args = list();
-    else
-        args = list_elem();
-
+    const auto args = list_elem();
     expect(Kind::RParen);
     if (args.empty())
         error("Invalid empty argument list");
@@ -284,25 +540,52 @@ List Parser::arg_list()
 
 List Parser::list_elem()
 {
-    List list;
+    return splice(value_list());
+}
+
+std::vector<Value> Parser::value_list()
+{
+    std::vector<Value> values;
     if (!peek(Kind::RParen) && !peek(Kind::RBracket)) {
         do {
-            list.emplace_back(expr());
+            values.push_back(expr());
         } while (consume(Kind::Comma));
     }
+    return values;
+}
+
+List Parser::splice(const std::vector<Value>& values)
+{   // lists among the values contribute all their elements
+    List list;
+    for (const auto& val : values) {
+        if (val.is_list()) {
+            const auto elems = to_list(*val.list());
+            list.insert(end(list), cbegin(elems), cend(elems));
+        }
+        else
+            list.push_back(number(val));
+    }
     return list;
 }
 
-const std::string& Parser::ident()
+Complex Parser::number(const Value& val)
 {
+    if (val.is_list())
+        error("Expected a number, not a list");
+    if (val.is_matrix())
+        error("Expected a number, not a matrix");
+    return val.num();
+}
+
+const std::string& Parser::ident()
+{   // refers into the token ring, copy it before consuming many more tokens
     expect(Kind::String);
-    return prevTok.str;
+    return ts.previous().str;
 }
 
 bool Parser::consume(Kind kind)
 {
     if (ts.current().kind == kind) {
-        prevTok = ts.current();
         ts.get();
         return true;
     }
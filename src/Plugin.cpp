@@ -0,0 +1,181 @@
+#include "Plugin.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <stdexcept>
+#include <vector>
+
+#include "Builtin.hpp"
+#include "SymbolTable.hpp"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <dlfcn.h>
+#endif
+
+// Arguments and results are passed in place, without converting
+static_assert(sizeof(dc_complex) == sizeof(Complex), "dc_complex has to match std::complex<double>");
+
+static const dc_complex* to_c(const Complex* c) noexcept
+{
+    return reinterpret_cast<const dc_complex*>(c);
+}
+
+static dc_complex* to_c(Complex* c) noexcept
+{
+    return reinterpret_cast<dc_complex*>(c);
+}
+
+#ifdef _WIN32
+
+PluginLibrary::PluginLibrary(const std::string& path)
+    : file{ path }, handle{ LoadLibraryA(path.c_str()) }
+{
+    if (!handle)
+        throw std::runtime_error{ "Cannot load plugin " + path + " (error " + std::to_string(GetLastError()) + ")" };
+}
+
+PluginLibrary::~PluginLibrary()
+{
+    FreeLibrary(static_cast<HMODULE>(handle));
+}
+
+void* PluginLibrary::symbol(const char* name) const noexcept
+{
+    return reinterpret_cast<void*>(GetProcAddress(static_cast<HMODULE>(handle), name));
+}
+
+#else
+
+PluginLibrary::PluginLibrary(const std::string& path)
+    : file{ path }, handle{ ::dlopen(path.c_str(), RTLD_NOW | RTLD_LOCAL) }
+{
+    if (!handle)
+        throw std::runtime_error{ "Cannot load plugin " + path + " (" + ::dlerror() + ")" };
+}
+
+PluginLibrary::~PluginLibrary()
+{
+    ::dlclose(handle);
+}
+
+void* PluginLibrary::symbol(const char* name) const noexcept
+{
+    return ::dlsym(handle, name);
+}
+
+#endif
+
+NativeFunction::NativeFunction(const dc_function& f, std::shared_ptr<const PluginLibrary> library)
+    : funcName{ f.name }, numArgs{ f.arity }, pure{ f.pure != 0 }, scalar{ f.scalar }, batch{ f.batch },
+      lib{ std::move(library) }
+{
+}
+
+void NativeFunction::check_arity(std::size_t n) const
+{
+    ::check_arity(funcName, numArgs, n);
+}
+
+Complex NativeFunction::operator()(const Complex* args, std::size_t n) const
+{
+    Complex res;
+    check(scalar(to_c(args), n, to_c(&res)));
+    return res;
+}
+
+void NativeFunction::eval(const Complex* const* args, std::size_t nargs, Complex* out, std::size_t n) const
+{
+    if (batch) {
+        check(batch(reinterpret_cast<const dc_complex* const*>(args), nargs, to_c(out), n));
+        return;
+    }
+    Complex small[8];  // one element of every argument
+    std::vector<Complex> many(nargs > 8 ? nargs : 0);
+    const auto elem = many.empty() ? small : many.data();
+    for (std::size_t i = 0; i < n; ++i) {
+        for (std::size_t j = 0; j < nargs; ++j)
+            elem[j] = args[j][i];
+        out[i] = (*this)(elem, nargs);
+    }
+}
+
+void NativeFunction::check(int rc) const
+{
+    if (rc)
+        throw std::runtime_error{ funcName + " failed (error " + std::to_string(rc) + ")" };
+}
+
+namespace {
+
+struct Registration {
+    const SymbolTable& table;
+    std::shared_ptr<const PluginLibrary> lib;
+    std::vector<std::shared_ptr<const NativeFunction>> funcs;
+    std::string error;
+};
+
+bool is_identifier(const char* name)
+{
+    if (!name || !(std::isalpha(static_cast<unsigned char>(*name)) || *name == '_'))
+        return false;
+    return std::all_of(name, name + std::char_traits<char>::length(name),
+                       [](char c) { return std::isalnum(static_cast<unsigned char>(c)) || c == '_'; });
+}
+
+// Called back by the plugin; checked here, added to the table once init succeeded
+int register_function(void* context, const dc_function* f) noexcept
+{
+    auto& reg = *static_cast<Registration*>(context);
+    try {  // nothing may unwind into the plugin
+        if (!reg.error.empty())
+            return 1;
+        if (!f || f->struct_size < sizeof(dc_function))
+            reg.error = "Function registered through an older plugin interface";
+        else if (!is_identifier(f->name))
+            reg.error = "Invalid function name";
+        else if (!f->scalar)
+            reg.error = std::string{ f->name } + " has no scalar entry point";
+        else if (f->arity < DESKCALC_VARIADIC || f->arity == 0)
+            reg.error = std::string{ f->name } + " has invalid arity " + std::to_string(f->arity);
+        else if ((reg.table.is_reserved_func(f->name) && !reg.table.find_native(f->name)) || reg.table.has_func(f->name))
+            reg.error = std::string{ f->name } + " is already defined";
+        else {  // copies the name, which only has to live during the call
+            reg.funcs.push_back(std::make_shared<const NativeFunction>(*f, reg.lib));
+            return 0;
+        }
+    }
+    catch (const std::exception& e) {
+        if (reg.error.empty())
+            reg.error = e.what();
+    }
+    catch (...) {
+        if (reg.error.empty())
+            reg.error = "Registering a function failed";
+    }
+    return 1;
+}
+
+}   // anonymous namespace
+
+std::size_t load_plugin(SymbolTable& table, const std::string& path)
+{
+    const auto lib = std::make_shared<const PluginLibrary>(path);
+    const auto init = reinterpret_cast<dc_plugin_init_fn>(lib->symbol(DESKCALC_PLUGIN_INIT));
+    if (!init)
+        throw std::runtime_error{ path + " does not export " DESKCALC_PLUGIN_INIT };
+
+    Registration reg{ table, lib, {}, {} };
+    const dc_host host{ DESKCALC_PLUGIN_ABI_VERSION, &reg, register_function };
+    const auto rc = init(&host);
+    if (!reg.error.empty())  // the likely reason if init failed too
+        throw std::runtime_error{ "Plugin " + path + ": " + reg.error };
+    if (rc)
+        throw std::runtime_error{ "Plugin " + path + " failed to initialize (error " + std::to_string(rc) + ")" };
+
+    for (auto& f : reg.funcs)
+        table.add_native(std::move(f));
+    return reg.funcs.size();
+}
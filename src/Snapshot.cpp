@@ -0,0 +1,273 @@
+#include "Snapshot.hpp"
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+#include "Function.hpp"
+#include "MappedFile.hpp"
+#include "SymbolTable.hpp"
+#include "types.hpp"
+
+// Layout (native byte order, checked on load through byteOrderMark):
+//   magic[8] version:u32 byteOrderMark:u32
+//   numVars:u32  { name:str access:u8 real:f64 imag:f64 }
+//   numLists:u32 { name:str size:u64 data:f64[2*size] }
+//   numMatrices:u32 { name:str rows:u64 cols:u64 data:f64[2*rows*cols] }  (since version 2)
+//   numFuncs:u32 { name:str numParams:u32 { param:str } term:str }
+// where str is a u32 length followed by the characters.
+
+static constexpr char magic[8]{ 'D', 'E', 'S', 'K', 'C', 'A', 'L', 'C' };
+static constexpr std::uint32_t version{ 2 };
+static constexpr std::uint32_t byteOrderMark{ 0x01020304 };
+
+namespace {
+
+class SnapshotWriter {
+public:
+    template<class T>
+    void put(const T& value)
+    {
+        buf.append(reinterpret_cast<const char*>(&value), sizeof value);
+    }
+
+    void put(const std::string& str)
+    {
+        put(static_cast<std::uint32_t>(str.size()));
+        buf += str;
+    }
+
+    void put(ListView list)
+    {
+        put(static_cast<std::uint64_t>(list.size()));
+        buf.append(reinterpret_cast<const char*>(list.data()), list.size() * sizeof(Complex));
+    }
+
+    void put(const Matrix& matrix)
+    {
+        put(static_cast<std::uint64_t>(matrix.rows()));
+        put(static_cast<std::uint64_t>(matrix.cols()));
+        buf.append(reinterpret_cast<const char*>(matrix.elements().data()), matrix.elements().size() * sizeof(Complex));
+    }
+
+    void write_to(const std::string& path) const
+    {
+        std::ofstream ofs{ path, std::ios::binary };
+        if (!ofs.write(buf.data(), static_cast<std::streamsize>(buf.size())))
+            throw std::runtime_error{ "Cannot write snapshot " + path };
+    }
+
+    std::string buf;
+};
+
+class SnapshotReader {
+public:
+    SnapshotReader(const char* data, std::size_t size)
+        : pos{ data }, last{ data + size } { }
+
+    template<class T>
+    T get()
+    {
+        T value;
+        std::memcpy(&value, take(sizeof value), sizeof value);
+        return value;
+    }
+
+    std::string get_str()
+    {
+        const auto len = get<std::uint32_t>();
+        return { take(len), len };
+    }
+
+    // Number of records that follow, each at least minBytes long
+    std::size_t get_count(std::size_t minBytes)
+    {
+        const auto count = get<std::uint32_t>();
+        if (count > static_cast<std::size_t>(last - pos) / minBytes)
+            corrupt();
+        return count;
+    }
+
+    VarAccess get_access()
+    {
+        const auto access = get<std::uint8_t>();
+        if (access != static_cast<std::uint8_t>(VarAccess::Mutable) && access != static_cast<std::uint8_t>(VarAccess::Const))
+            corrupt();
+        return static_cast<VarAccess>(access);
+    }
+
+    List get_list()
+    {
+        const auto size = get<std::uint64_t>();
+        if (size > static_cast<std::uint64_t>(last - pos) / sizeof(Complex))
+            corrupt();
+        List list(static_cast<std::size_t>(size));
+        std::memcpy(list.data(), take(list.size() * sizeof(Complex)), list.size() * sizeof(Complex));
+        return list;
+    }
+
+    Matrix get_matrix()
+    {
+        const auto rows = get<std::uint64_t>();
+        const auto cols = get<std::uint64_t>();
+        if (cols && rows > static_cast<std::uint64_t>(last - pos) / sizeof(Complex) / cols)
+            corrupt();
+        Matrix matrix{ static_cast<std::size_t>(rows), static_cast<std::size_t>(cols) };
+        for (std::size_t i = 0; i < matrix.rows(); ++i)
+            std::memcpy(matrix.row(i), take(matrix.cols() * sizeof(Complex)), matrix.cols() * sizeof(Complex));
+        return matrix;
+    }
+
+    bool at_end() const { return pos == last; }
+
+private:
+    const char* take(std::size_t n)
+    {
+        if (n > static_cast<std::size_t>(last - pos))
+            corrupt();
+        const auto p = pos;
+        pos += n;
+        return p;
+    }
+
+    [[noreturn]] static void corrupt()
+    {
+        throw std::runtime_error{ "Snapshot is truncated or corrupt" };
+    }
+
+    const char* pos;
+    const char* last;
+};
+
+struct FuncRecord {
+    std::string name;
+    std::vector<std::string> vars;
+    std::string term;
+};
+
+}   // anonymous namespace
+
+void save_snapshot(const SymbolTable& table, const std::string& path)
+{
+    SnapshotWriter w;
+    w.buf.append(magic, sizeof magic);
+    w.put(version);
+    w.put(byteOrderMark);
+
+    w.put(static_cast<std::uint32_t>(table.vars().size()));
+    for (const auto& v : table.vars()) {
+        w.put(v.first);
+        w.put(static_cast<std::uint8_t>(v.second.access));
+        w.put(v.second.value.real());
+        w.put(v.second.value.imag());
+    }
+
+    w.put(static_cast<std::uint32_t>(table.lists().size()));
+    for (const auto& l : table.lists()) {
+        w.put(l.first);
+        w.put(l.second.view());
+    }
+
+    w.put(static_cast<std::uint32_t>(table.matrices().size()));
+    for (const auto& m : table.matrices()) {
+        w.put(m.first);
+        w.put(*m.second);
+    }
+
+    w.put(static_cast<std::uint32_t>(table.funcs().size()));
+    for (const auto& f : table.funcs()) {
+        w.put(f.first);
+        w.put(static_cast<std::uint32_t>(f.second.get_vars().size()));
+        for (const auto& var : f.second.get_vars())
+            w.put(var);
+        w.put(f.second.get_term());
+    }
+
+    w.write_to(path);
+}
+
+void load_snapshot(SymbolTable& table, const std::string& path)
+{
+    const MappedFile file{ path };
+    SnapshotReader r{ file.data(), file.size() };
+
+    if (file.size() < sizeof magic || std::memcmp(file.data(), magic, sizeof magic))
+        throw std::runtime_error{ path + " is not a DeskCalc snapshot" };
+    r.get<std::uint64_t>();
+    const auto fileVersion = r.get<std::uint32_t>();
+    if (fileVersion != 1 && fileVersion != version)
+        throw std::runtime_error{ "Unsupported snapshot version" };
+    if (r.get<std::uint32_t>() != byteOrderMark)
+        throw std::runtime_error{ "Snapshot was written on a machine with different byte order" };
+
+    // Read everything before touching the table, so a corrupt file changes nothing
+    // counts are checked against the bytes left before allocating anything for them
+    constexpr std::size_t strBytes{ sizeof(std::uint32_t) };
+    std::vector<std::pair<std::string, Var>> vars(r.get_count(strBytes + 1 + 2 * sizeof(double)));
+    for (auto& v : vars) {
+        v.first = r.get_str();
+        v.second.access = r.get_access();
+        const auto re = r.get<double>();
+        v.second.value = { re, r.get<double>() };
+    }
+
+    std::vector<std::pair<std::string, List>> lists(r.get_count(strBytes + sizeof(std::uint64_t)));
+    for (auto& l : lists) {
+        l.first = r.get_str();
+        l.second = r.get_list();
+    }
+
+    std::vector<std::pair<std::string, Matrix>> matrices(fileVersion > 1 ? r.get_count(strBytes + 2 * sizeof(std::uint64_t)) : 0);
+    for (auto& m : matrices) {
+        m.first = r.get_str();
+        m.second = r.get_matrix();
+    }
+
+    std::vector<FuncRecord> funcs(r.get_count(3 * strBytes));
+    for (auto& f : funcs) {
+        f.name = r.get_str();
+        f.vars.resize(r.get_count(strBytes));
+        for (auto& var : f.vars)
+            var = r.get_str();
+        f.term = r.get_str();
+    }
+
+    if (!r.at_end())
+        throw std::runtime_error{ "Snapshot is truncated or corrupt" };
+
+    // loaded symbols replace others of the same name, whatever their kind
+    for (auto& v : vars) {
+        table.remove_list(v.first);
+        table.remove_matrix(v.first);
+        table.remove_func(v.first);
+        if (v.second.access == VarAccess::Const)
+            table.set_const(v.first, v.second.value);
+        else
+            table.set_var(v.first, v.second.value);
+    }
+    for (auto& l : lists) {
+        table.remove_var(l.first);
+        table.remove_matrix(l.first);
+        table.remove_func(l.first);
+        table.set_list(l.first, std::move(l.second));
+    }
+    for (auto& m : matrices) {
+        table.remove_var(m.first);
+        table.remove_list(m.first);
+        table.remove_func(m.first);
+        table.set_matrix(m.first, std::make_shared<const Matrix>(std::move(m.second)));
+    }
+    for (auto& f : funcs) {
+        table.remove_var(f.name);
+        table.remove_list(f.name);
+        table.remove_matrix(f.name);
+        Function func{ f.name, table };
+        for (const auto& var : f.vars)
+            func.add_var(var);
+        func.set_term(f.term);
+        table.set_func(f.name, std::move(func));
+    }
+}
@@ -0,0 +1,106 @@
+#include "StoredList.hpp"
+
+#include <fstream>
+#include <stdexcept>
+
+namespace {
+
+// Largest storage kept for the next assign; longer lists free the old
+// elements, so they never hold twice their memory
+constexpr std::size_t maxSpare{ 1 << 16 };
+
+}   // anonymous namespace
+
+StoredList StoredList::map(const std::string& path, MapMode mode)
+{
+    if (!host_is_little_endian())
+        throw std::runtime_error{ "Mapped lists need a little-endian machine" };
+
+    StoredList list;
+    list.file = std::make_shared<MappedFile>(path, mode);
+    if (!list.file->size() || list.file->size() % sizeof(Complex))
+        throw std::runtime_error{ path + " is not an array of complex doubles" };
+    return list;
+}
+
+ListView StoredList::view() const noexcept
+{
+    if (is_mapped())  // mappings are page aligned, so the data is suitably aligned for Complex
+        return { reinterpret_cast<const Complex*>(file->data()), file->size() / sizeof(Complex) };
+    return values ? ListView{ *values } : ListView{};
+}
+
+std::shared_ptr<const void> StoredList::owner() const noexcept
+{
+    if (is_mapped())
+        return file;
+    return values;
+}
+
+Complex* StoredList::mutable_data()
+{
+    sorted = false;
+    if (is_mapped() && file.use_count() == 1 && file->mutable_data())
+        return reinterpret_cast<Complex*>(file->mutable_data());
+    if (is_mapped() || is_shared()) {
+        values = std::make_shared<List>(view().to_list());
+        file.reset();
+    }
+    return values ? values->data() : nullptr;
+}
+
+void StoredList::assign(const ListExpr& expr)
+{   // evaluated into the spare storage, the old elements stay until that succeeded
+    auto next = std::move(spare);
+    next.resize(expr.size());
+    try {
+        eval_to(expr, next.data());
+    }
+    catch (...) {
+        if (next.capacity() <= maxSpare)
+            spare = std::move(next);
+        throw;
+    }
+    if (values && !is_shared()) {
+        if (values->capacity() <= maxSpare)
+            spare = std::move(*values);
+        *values = std::move(next);
+    }
+    else {  // whoever shares the old elements keeps them
+        values = std::make_shared<List>(std::move(next));
+        file.reset();
+    }
+    sorted = expr.is_sorted();
+}
+
+void StoredList::append(const ListExpr& expr)
+{
+    sorted = false;
+    if (is_mapped() || !values || is_shared() || expr.reads_from(view())) {
+        const auto elems = to_list(expr);
+        if (is_mapped() || !values || is_shared()) {
+            values = std::make_shared<List>(view().to_list());
+            file.reset();
+        }
+        values->insert(end(*values), cbegin(elems), cend(elems));
+        return;
+    }
+    const auto size = values->size();
+    values->resize(size + expr.size());
+    try {
+        eval_to(expr, values->data() + size);
+    }
+    catch (...) {
+        values->resize(size);
+        throw;
+    }
+}
+
+void write_raw_list(ListView list, const std::string& path)
+{
+    if (!host_is_little_endian())
+        throw std::runtime_error{ "Raw lists need a little-endian machine" };
+    std::ofstream ofs{ path, std::ios::binary };
+    if (!ofs.write(reinterpret_cast<const char*>(list.data()), static_cast<std::streamsize>(list.size() * sizeof(Complex))))
+        throw std::runtime_error{ "Cannot write list to " + path };
+}
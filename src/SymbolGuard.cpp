@@ -16,13 +16,12 @@ SymbolGuard::~SymbolGuard()
 
 void SymbolGuard::shadow_var(const std::string& name, Complex tempVal)
 {
-	if (table.has_list(name)) {
+	if (table.has_list(name) || table.has_matrix(name)) {
 		throw std::runtime_error("Attempt to use reserved list identifier as another symbol");
 	}
 	
-    if (table.has_var(name)) {
-        const auto val = table.value_of(name);
-        varCache[name] = val;
+    if (const auto var = table.find_var(name)) {
+        varCache[name] = var->value;
         table.remove_var(name);
     }
     table.set_var(name, tempVal);
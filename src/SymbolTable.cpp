@@ -1,13 +1,20 @@
 #include "SymbolTable.hpp"
 
 #include <cassert>
+#include <cmath>
+#include <iterator>
 #include <iostream>
 #include <numeric>
 #include <stdexcept>
 
 #include <mps/stl_util.hpp>
 
+#include "Histogram.hpp"
+#include "linalg.hpp"
 #include "math_util.hpp"
+#include "OrderStatistics.hpp"
+#include "StaticStrMap.hpp"
+#include "vecmath.hpp"
 
 
 SymbolTable::SymbolTable()
@@ -15,11 +22,6 @@ SymbolTable::SymbolTable()
     add_constants();
 }
 
-bool SymbolTable::is_reserved_func(const std::string& name) const
-{
-    return mps::stl::contains(defaultFuncTable, name);
-}
-
 void SymbolTable::set_const(ConstStrRef name, Complex val)
 {
     varTable[name] = make_const_var(std::move(val));
@@ -32,7 +34,38 @@ void SymbolTable::set_var(ConstStrRef name, Complex val)
 
 void SymbolTable::set_list(ConstStrRef name, List&& list)
 {
-    listTable[name] = list;
+    listTable[name] = StoredList{ std::move(list) };
+}
+
+void SymbolTable::set_list(ConstStrRef name, const ListExpr& expr)
+{
+    const auto found = listTable.find(name);
+    if (found == end(listTable)) {
+        StoredList list;
+        list.assign(expr);
+        listTable.emplace(name, std::move(list));
+    }
+    else
+        found->second.assign(expr);
+}
+
+void SymbolTable::append_list(ConstStrRef name, const ListExpr& expr)
+{
+    const auto found = listTable.find(name);
+    if (found == end(listTable))
+        listTable.emplace(name, to_list(expr));
+    else
+        found->second.append(expr);
+}
+
+void SymbolTable::set_matrix(ConstStrRef name, MatrixPtr matrix)
+{
+    matrixTable[name] = std::move(matrix);
+}
+
+void SymbolTable::map_list(ConstStrRef name, const std::string& path, MapMode mode)
+{
+    listTable[name] = StoredList::map(path, mode);
 }
 
 void SymbolTable::set_func(ConstStrRef name, Function func)
@@ -41,22 +74,71 @@ void SymbolTable::set_func(ConstStrRef name, Function func)
     funcTable.emplace(name, std::move(func));
 }
 
+void SymbolTable::add_native(std::shared_ptr<const NativeFunction> func)
+{
+    auto& entry = nativeTable[func->name()];
+    entry = std::move(func);
+}
+
 Complex SymbolTable::value_of(ConstStrRef var) const
 {
-    return mps::stl::find_or_throw(varTable, var, "Variable " + var + " is undefined")->second.value;
+    if (const auto v = find_var(var))
+        return v->value;
+    throw std::runtime_error{ "Variable " + var + " is undefined" };
 }
 
-const List& SymbolTable::list(ConstStrRef name) const
+ListView SymbolTable::list(ConstStrRef name) const
 {
-    return mps::stl::find_or_throw(listTable, name, "List " + name + " is undefined")->second;
+    if (const auto l = find_list(name))
+        return l->view();
+    throw std::runtime_error{ "List " + name + " is undefined" };
 }
 
 Complex SymbolTable::call_func(ConstStrRef func, const List& arg) const
 {
-    const auto f = funcTable.find(func);
-    if (f != cend(funcTable))
-        return f->second(arg);
-    return mps::stl::find_or_throw(defaultFuncTable, func, "Function " + func + " is undefined")->second(arg);
+    if (const auto f = find_func(func))
+        return (*f)(arg);
+    if (const auto f = find_builtin(func)) {
+        f->check_arity(func, arg.size());
+        return (*f)(arg.data(), arg.size());
+    }
+    if (const auto r = find_reduction(func))
+        return r(arg, reduceOpts);
+    if (const auto f = find_native(func)) {
+        f->check_arity(arg.size());
+        return (*f)(arg.data(), arg.size());
+    }
+    throw std::runtime_error{ "Function " + func + " is undefined" };
+}
+
+const Var* SymbolTable::find_var(ConstStrRef name) const noexcept
+{
+    const auto found = varTable.find(name);
+    return found != cend(varTable) ? &found->second : nullptr;
+}
+
+const StoredList* SymbolTable::find_list(ConstStrRef name) const noexcept
+{
+    const auto found = listTable.find(name);
+    return found != cend(listTable) ? &found->second : nullptr;
+}
+
+MatrixPtr SymbolTable::find_matrix(ConstStrRef name) const noexcept
+{
+    const auto found = matrixTable.find(name);
+    return found != cend(matrixTable) ? found->second : nullptr;
+}
+
+const Function* SymbolTable::find_func(ConstStrRef name) const noexcept
+{
+    const auto found = funcTable.find(name);
+    return found != cend(funcTable) ? &found->second : nullptr;
+}
+
+std::shared_ptr<const NativeFunction> SymbolTable::find_native(ConstStrRef name) const noexcept
+{
+    const auto found = nativeTable.find(name);
+    return found != cend(nativeTable) ? found->second : nullptr;
 }
 
 bool SymbolTable::is_const(ConstStrRef name) const
@@ -75,6 +157,11 @@ bool SymbolTable::has_list(ConstStrRef name) const
     return mps::stl::contains(listTable, name);
 }
 
+bool SymbolTable::has_matrix(ConstStrRef name) const
+{
+    return mps::stl::contains(matrixTable, name);
+}
+
 bool SymbolTable::has_func(ConstStrRef name) const
 {
     return mps::stl::contains(funcTable, name);
@@ -82,7 +169,7 @@ bool SymbolTable::has_func(ConstStrRef name) const
 
 bool SymbolTable::isset(ConstStrRef name) const
 {
-    return has_var(name) || has_list(name) || has_func(name);
+    return has_var(name) || has_list(name) || has_matrix(name) || has_func(name);
 }
 
 void SymbolTable::remove_var(ConstStrRef name)
@@ -95,6 +182,11 @@ void SymbolTable::remove_list(ConstStrRef name)
     listTable.erase(name);
 }
 
+void SymbolTable::remove_matrix(ConstStrRef name)
+{
+    matrixTable.erase(name);
+}
+
 void SymbolTable::remove_func(ConstStrRef name)
 {
     funcTable.erase(name);
@@ -108,6 +200,8 @@ void SymbolTable::remove_symbol(ConstStrRef name)
         remove_func(name);
     if (has_list(name))
         remove_list(name);
+    if (has_matrix(name))
+        remove_matrix(name);
     if (has_var(name))
         remove_var(name);
 }
@@ -117,6 +211,7 @@ void SymbolTable::clear()
     clear_vars();
     clear_funcs();
     clear_lists();
+    clear_matrices();
 }
 
 void SymbolTable::clear_vars()
@@ -135,6 +230,11 @@ void SymbolTable::clear_lists()
     listTable.clear();
 }
 
+void SymbolTable::clear_matrices()
+{
+    matrixTable.clear();
+}
+
 void SymbolTable::add_constants()
 {
     varTable["i"] = make_const_var({0, 1});
@@ -143,77 +243,185 @@ void SymbolTable::add_constants()
     varTable["deg"] = make_const_var(pi / 180);
 }
 
-#define CHECK_SINGLE_ARG(f) \
-    if (list.size() != 1) throw std::runtime_error{ #f " expects exactly 1 argument" };
+#define MAKE_COMPLEX_FUNC(f) [] (const Complex& x) { \
+    return Complex{ (f)(x) }; }
+
+#define MAKE_REAL_FUNC(f) [] (const Complex& x) { \
+    if (x.imag()) \
+        throw std::runtime_error{ #f " not defined for complex numbers" }; \
+    return Complex{ static_cast<double>((f)(x.real())) }; }
+
+#define MAKE_REAL_BINARY_FUNC(f) [] (const Complex& x, const Complex& y) { \
+    if (x.imag() || y.imag()) \
+        throw std::runtime_error{ #f " not defined for complex numbers" }; \
+    return Complex{ (f)(x.real(), y.real()) }; }
 
-#define MAKE_COMPLEX_FUNC(f) [] (const List& list) { \
-    CHECK_SINGLE_ARG(f) \
-    return Complex{ (f)(list.front()) }; }
+#define MAKE_COMPLEX_ELEMENTS(f) [] (const Complex* in, Complex* out, std::size_t n) { \
+    for (std::size_t i = 0; i < n; ++i) \
+        out[i] = Complex{ (f)(in[i]) }; }
 
-#define MAKE_PROXY_FUNC(f) [] (const Complex& c) { \
-        if (c.imag()) \
+#define MAKE_REAL_ELEMENTS(f) [] (const Complex* in, Complex* out, std::size_t n) { \
+    for (std::size_t i = 0; i < n; ++i) { \
+        if (in[i].imag()) \
             throw std::runtime_error{ #f " not defined for complex numbers" }; \
-        return Complex{ (f)(c.real()) }; }
+        out[i] = Complex{ static_cast<double>((f)(in[i].real())) }; } }
 
-#define MAKE_REAL_FUNC(f) [] (const List& list) { \
-    CHECK_SINGLE_ARG(f) \
-    if (list.front().imag()) \
-        throw std::runtime_error{ #f " not defined for complex numbers" }; \
-    return Complex{ static_cast<double>((f)(list.front().real())) }; }
+#define COMPLEX_BUILTIN(f) Builtin{ MAKE_COMPLEX_FUNC(f), MAKE_COMPLEX_ELEMENTS(f) }
+#define REAL_BUILTIN(f) Builtin{ MAKE_REAL_FUNC(f), MAKE_REAL_ELEMENTS(f) }
 
 using namespace std;
 using namespace temp;
-const SymbolTable::FuncMap SymbolTable::defaultFuncTable{
-    { "sin", MAKE_COMPLEX_FUNC(sin) },
-    { "cos", MAKE_COMPLEX_FUNC(cos) },
-    { "tan", MAKE_COMPLEX_FUNC(tan) },
-    { "asin", MAKE_COMPLEX_FUNC(asin) },
-    { "acos", MAKE_COMPLEX_FUNC(acos) },
-    { "atan", MAKE_COMPLEX_FUNC(atan) },
-    { "sinh", MAKE_COMPLEX_FUNC(sinh) },
-    { "cosh", MAKE_COMPLEX_FUNC(cosh) },
-    { "tanh", MAKE_COMPLEX_FUNC(tanh) },
-    { "asinh", MAKE_COMPLEX_FUNC(asinh) },
-    { "acosh", MAKE_COMPLEX_FUNC(acosh) },
-    { "atanh", MAKE_COMPLEX_FUNC(atanh) },
-    { "deg", MAKE_REAL_FUNC(deg) },
-    { "rad", MAKE_REAL_FUNC(rad) },
-	{ "sgn", MAKE_REAL_FUNC(sign<double>) }, 
-
-    { "CtoK", MAKE_REAL_FUNC(CtoK) },
-    { "KtoC", MAKE_REAL_FUNC(KtoC) },
-    { "FtoC", MAKE_REAL_FUNC(FtoC) },
-    { "CtoF", MAKE_REAL_FUNC(CtoF) },
-    { "FtoK", MAKE_REAL_FUNC(FtoK) },
-    { "KtoF", MAKE_REAL_FUNC(KtoF) },
-
-    { "abs", MAKE_COMPLEX_FUNC(abs) },
-    { "norm", MAKE_COMPLEX_FUNC(norm) },
-    { "arg", MAKE_COMPLEX_FUNC(arg) },
-    { "exp", MAKE_COMPLEX_FUNC(exp) },
-
-    { "sqr", MAKE_COMPLEX_FUNC(sqr) },
-    { "sqrt", MAKE_COMPLEX_FUNC(sqrt) },
-    { "ln", MAKE_COMPLEX_FUNC(log) },
-    { "log", MAKE_COMPLEX_FUNC(log10) },
-
-    { "Re", MAKE_COMPLEX_FUNC(real) },
-    { "Im", MAKE_COMPLEX_FUNC(imag) },
-
-    { "floor", MAKE_REAL_FUNC(floor) },
-    { "ceil", MAKE_REAL_FUNC(ceil) },
-    { "round", MAKE_REAL_FUNC(round) },
-    { "trunc", MAKE_REAL_FUNC(trunc) },
-
-    { "cbrt", MAKE_REAL_FUNC(cbrt) },
+// Built-in functions, hashed at compile time (see StaticStrMap). Lists are mapped
+// element by element, the functions in vecmath.hpp vectorize real lists.
+static constexpr std::pair<std::string_view, Builtin> builtinFuncs[]{
+    { "sin", Builtin{ MAKE_COMPLEX_FUNC(sin), vec_sin } },
+    { "cos", Builtin{ MAKE_COMPLEX_FUNC(cos), vec_cos } },
+    { "tan", COMPLEX_BUILTIN(tan) },
+    { "asin", COMPLEX_BUILTIN(asin) },
+    { "acos", COMPLEX_BUILTIN(acos) },
+    { "atan", COMPLEX_BUILTIN(atan) },
+    { "sinh", COMPLEX_BUILTIN(sinh) },
+    { "cosh", COMPLEX_BUILTIN(cosh) },
+    { "tanh", COMPLEX_BUILTIN(tanh) },
+    { "asinh", COMPLEX_BUILTIN(asinh) },
+    { "acosh", COMPLEX_BUILTIN(acosh) },
+    { "atanh", COMPLEX_BUILTIN(atanh) },
+    { "deg", REAL_BUILTIN(deg) },
+    { "rad", REAL_BUILTIN(rad) },
+	{ "sgn", REAL_BUILTIN(sign<double>) }, 
+
+    { "CtoK", REAL_BUILTIN(CtoK) },
+    { "KtoC", REAL_BUILTIN(KtoC) },
+    { "FtoC", REAL_BUILTIN(FtoC) },
+    { "CtoF", REAL_BUILTIN(CtoF) },
+    { "FtoK", REAL_BUILTIN(FtoK) },
+    { "KtoF", REAL_BUILTIN(KtoF) },
+
+    { "abs", Builtin{ MAKE_COMPLEX_FUNC(abs), vec_abs } },
+    { "norm", COMPLEX_BUILTIN(norm) },
+    { "arg", COMPLEX_BUILTIN(arg) },
+    { "exp", Builtin{ MAKE_COMPLEX_FUNC(exp), vec_exp } },
+
+    { "sqr", COMPLEX_BUILTIN(sqr) },
+    { "sqrt", Builtin{ MAKE_COMPLEX_FUNC(sqrt), vec_sqrt } },
+    { "ln", Builtin{ MAKE_COMPLEX_FUNC(log), vec_log } },
+    { "log", COMPLEX_BUILTIN(log10) },
+
+    { "Re", COMPLEX_BUILTIN(real) },
+    { "Im", COMPLEX_BUILTIN(imag) },
+
+    { "floor", REAL_BUILTIN(floor) },
+    { "ceil", REAL_BUILTIN(ceil) },
+    { "round", REAL_BUILTIN(round) },
+    { "trunc", REAL_BUILTIN(trunc) },
+
+    { "cbrt", REAL_BUILTIN(cbrt) },
+    { "atan2", Builtin{ MAKE_REAL_BINARY_FUNC(atan2) } },
+    { "hypot", Builtin{ MAKE_REAL_BINARY_FUNC(hypot) } },
+    { "gamma", COMPLEX_BUILTIN(tgamma) }
+};
+static constexpr StaticStrMap<Builtin, std::size(builtinFuncs)> builtins{ builtinFuncs };
 
+// List reductions, which follow the session's ReduceOptions
+static constexpr std::pair<std::string_view, Reduction> reductionFuncs[]{
+    { "len", [](ListSource l, const ReduceOptions&) { return Complex{static_cast<double>(len(l))}; } },
     { "sum", sum },
     { "sum2", sqr_sum },
     { "avg", avg },
-    { "len", [](const List& l) { return Complex{static_cast<double>(len(l))}; } },
     { "sx", standard_deviation },
-    { "ux", standard_uncertainty }
+    { "ux", standard_uncertainty },
+    { "min", list_min },
+    { "max", list_max },
+    { "median", median }
+};
+static constexpr StaticStrMap<Reduction, std::size(reductionFuncs)> reductions{ reductionFuncs };
+
+static constexpr std::pair<std::string_view, ListFunc> listFuncs[]{
+    { "percentile", [](ListSource l, const List& params, const ReduceOptions& opts) -> Value {
+        if (params.size() != 1 || params.front().imag())
+            throw std::runtime_error{ "Usage: percentile(list, p)" };
+        return percentile(l, params.front().real(), opts); } },
+    { "sort", [](ListSource l, const List& params, const ReduceOptions& opts) {
+        if (params.size())
+            throw std::runtime_error{ "sort expects a single list" };
+        return list_value(sorted(l, opts), true); } },
+    { "hist", [](ListSource l, const List& params, const ReduceOptions& opts) {
+        return list_value(binned(l, make_bins(l, params), BinStat::Count, opts)); } },
+    { "binsum", [](ListSource l, const List& params, const ReduceOptions& opts) {
+        return list_value(binned(l, make_bins(l, params), BinStat::Sum, opts)); } },
+    { "binavg", [](ListSource l, const List& params, const ReduceOptions& opts) {
+        return list_value(binned(l, make_bins(l, params), BinStat::Mean, opts)); } },
+    { "bincenter", [](ListSource l, const List& params, const ReduceOptions&) {
+        return list_value(bin_centers(make_bins(l, params))); } }
+};
+static constexpr StaticStrMap<ListFunc, std::size(listFuncs)> listFunctions{ listFuncs };
+
+static const Matrix& matrix_arg(const std::vector<Value>& args, std::size_t i, const char* usage)
+{
+    if (args.size() <= i || !args[i].is_matrix())
+        throw std::runtime_error{ std::string{ "Usage: " } + usage };
+    return *args[i].matrix();
+}
+
+// Matrix functions
+static constexpr std::pair<std::string_view, ValueFunc> valueFuncs[]{
+    { "inv", [](const std::vector<Value>& args) -> Value {
+        if (args.size() != 1)
+            throw std::runtime_error{ "Usage: inv(matrix)" };
+        return inverse(matrix_arg(args, 0, "inv(matrix)")); } },
+    { "det", [](const std::vector<Value>& args) -> Value {
+        if (args.size() != 1)
+            throw std::runtime_error{ "Usage: det(matrix)" };
+        return determinant(matrix_arg(args, 0, "det(matrix)")); } },
+    { "transpose", [](const std::vector<Value>& args) -> Value {
+        if (args.size() != 1)
+            throw std::runtime_error{ "Usage: transpose(matrix)" };
+        return transpose(matrix_arg(args, 0, "transpose(matrix)")); } },
+    { "solve", [](const std::vector<Value>& args) -> Value {
+        const auto usage = "solve(matrix, list or matrix)";
+        if (args.size() != 2)
+            throw std::runtime_error{ std::string{ "Usage: " } + usage };
+        const LU lu{ matrix_arg(args, 0, usage) };
+        if (args[1].is_list())
+            return list_value(lu.solve(to_list(*args[1].list())));
+        return lu.solve(matrix_arg(args, 1, usage)); } },
+    { "eye", [](const std::vector<Value>& args) -> Value {
+        if (args.size() != 1 || args[0].is_list() || args[0].is_matrix() || args[0].num().imag()
+            || args[0].num().real() != std::trunc(args[0].num().real()) || args[0].num().real() < 1
+            || args[0].num().real() > 1e4)
+            throw std::runtime_error{ "Usage: eye(n), n from 1 to 10000" };
+        return Matrix::identity(static_cast<std::size_t>(args[0].num().real())); } }
 };
+static constexpr StaticStrMap<ValueFunc, std::size(valueFuncs)> valueFunctions{ valueFuncs };
+
+bool SymbolTable::is_reserved_func(const std::string& name) const
+{
+    return builtins.contains(name) || reductions.contains(name) || listFunctions.contains(name)
+        || valueFunctions.contains(name) || nativeTable.count(name);
+}
+
+const Builtin* SymbolTable::find_builtin(std::string_view name) noexcept
+{
+    return builtins.find(name);
+}
+
+Reduction SymbolTable::find_reduction(std::string_view name) noexcept
+{
+    const auto r = reductions.find(name);
+    return r ? *r : nullptr;
+}
+
+ListFunc SymbolTable::find_list_func(std::string_view name) noexcept
+{
+    const auto f = listFunctions.find(name);
+    return f ? *f : nullptr;
+}
+
+ValueFunc SymbolTable::find_value_func(std::string_view name) noexcept
+{
+    const auto f = valueFunctions.find(name);
+    return f ? *f : nullptr;
+}
 
 Var make_const_var(Complex value)
 {
@@ -2,9 +2,11 @@
 
 #include <cassert>
 #include <cctype>
+#include <charconv>
+#include <cstdlib>
 #include <iostream>
-#include <map>
 #include <sstream>
+#include <stdexcept>
 
 TokenStream::TokenStream(std::istream& is)
     : input{ &is } { }
@@ -13,7 +15,7 @@ TokenStream::TokenStream(std::istream* is)
     : input{ is }, ownsInput{ true } { }
 
 TokenStream::TokenStream(const std::string& str)
-    : input{ new std::istringstream{str} }, ownsInput{ true } { }
+    : input{ &strInput }, strInput{ str } { }
 
 TokenStream::~TokenStream()
 {
@@ -35,7 +37,10 @@ void TokenStream::set_input(std::istream* is)
 
 void TokenStream::set_input(const std::string& str)
 {
-    set_input(new std::istringstream{ str });
+    cleanup();
+    strInput.str(str);
+    strInput.clear();
+    input = &strInput;
 }
 
 static constexpr unsigned char uchar(char ch)
@@ -43,18 +48,62 @@ static constexpr unsigned char uchar(char ch)
     return static_cast<unsigned char>(ch);
 }
 
-Token TokenStream::get()
+const Token& TokenStream::get()
+{
+    if (pos + 1 == lexed) {
+        lex(ring[lexed & mask]);
+        ++lexed;
+    }
+    ++pos;
+    return current();
+}
+
+const Token& TokenStream::peek(std::size_t ahead)
+{
+    if (ahead >= capacity - 1)
+        throw std::logic_error{ "TokenStream::peek beyond ring capacity" };
+    while (lexed <= pos + ahead) {
+        lex(ring[lexed & mask]);
+        ++lexed;
+    }
+    return ring[(pos + ahead) & mask];
+}
+
+void TokenStream::start_capture()
+{
+    captureStart = current().start;
+    capturing = true;
+}
+
+std::string TokenStream::end_capture()
+{
+    capturing = false;
+    auto first = begin(source) + static_cast<std::ptrdiff_t>(captureStart - sourceBase);
+    auto last = begin(source) + static_cast<std::ptrdiff_t>(current().start - sourceBase);
+    while (last != first && std::isspace(uchar(*(last - 1))))
+        --last;
+    return { first, last };
+}
+
+void TokenStream::lex(Token& tok)
 {
+    trim_source();
+
     char ch;
     do {
-        if (!input || !input->get(ch)) 
-            return ct = { Kind::End };
+        if (!input || !next_char(ch)) {
+            tok.start = sourceBase + source.size();
+            emit(tok, Kind::End);
+            return;
+        }
     } while (std::isspace(uchar(ch)) && ch != '\n');
+    tok.start = sourceBase + source.size() - 1;
 
     switch (ch) {
     case ';':
     case '\n':
-        return ct = { Kind::Print };
+        emit(tok, Kind::Print);
+        break;
     case '+':
     case '-':
     case '%':
@@ -66,66 +115,163 @@ Token TokenStream::get()
     case '(': case ')':
     case '[': case ']':
     case '{': case '}':
-        return ct = { static_cast<Kind>(ch) };
+        emit(tok, static_cast<Kind>(ch));
+        break;
     case '*':
-        return ct = parse_double_op('*', Kind::Pow, Kind::Mul);
+        emit(tok, parse_double_op('*', Kind::Pow, Kind::Mul));
+        break;
     case '/':
-        return ct = parse_double_op('/', Kind::FloorDiv, Kind::Div);
+        emit(tok, parse_double_op('/', Kind::FloorDiv, Kind::Div));
+        break;
     case '|':
-        return ct = parse_double_op('|', Kind::Parallel, Kind::Invalid);
+        emit(tok, parse_double_op('|', Kind::Parallel, Kind::Invalid));
+        break;
     case '0': case '1': case '2': case '3': case '4':
     case '5': case '6': case '7': case '8': case '9':
     case '.':
-        input->unget();
-        *input >> ct.num;
-        ct.kind = Kind::Number;
-        return ct;
+        parse_number(tok, ch);
+        emit(tok, Kind::Number);
+        break;
     default:
-        return ct = parse_identifier(ch);
+        parse_identifier(tok, ch);
     }
 }
 
-Token TokenStream::parse_double_op(char next, Kind onMatch, Kind onFailure)
+const Token& TokenStream::emit(Token& tok, Kind kind)
+{   // clear() instead of assigning a fresh Token keeps the capacity of tok.str
+    tok.kind = kind;
+    tok.str.clear();
+    return tok;
+}
+
+Kind TokenStream::parse_double_op(char next, Kind onMatch, Kind onFailure)
 {
     char c;
-    if (input->get(c) && c == next) 
-        return { onMatch };
+    if (next_char(c) && c == next) 
+        return onMatch;
     else {
-        input->unget();
+        put_back();
         if (onFailure != Kind::Invalid) 
-            return { onFailure };
+            return onFailure;
         error("Expected Token: ", next);
     }
-    return { Kind::Invalid };
 }
 
-Token TokenStream::parse_identifier(char ch)
+bool TokenStream::next_char(char& ch)
 {
-    if (std::isalpha(uchar(ch)) || ch == '_') {
-        std::string s{ ch };
-        while (input->get(ch) && (std::isalnum(uchar(ch)) || ch == '_'))
-            s += ch;
+    canPutBack = static_cast<bool>(input->get(ch));
+    if (canPutBack)
+        source += ch;
+    return canPutBack;
+}
+
+void TokenStream::put_back()
+{   // only the character read last can be put back, and only if there was one
+    if (canPutBack) {
         input->unget();
-        return identifier_to_token(s);
+        source.pop_back();
+        canPutBack = false;
     }
-    error("Bad Token ", ch);
-    return { Kind::Invalid };
 }
 
-static const std::map<std::string, Kind> strTokens{
-    { "div", Kind::FloorDiv },
-    { "mod", Kind::Mod },
-    { "del", Kind::Delete },
-    { "fn", Kind::FuncDef },
-    { "for", Kind::For }
-};
+void TokenStream::trim_source()
+{   // only the text from the current token on can still be captured
+    constexpr std::size_t keep{ 4096 };
+    if (capturing || source.size() < keep)
+        return;
+    const auto drop = current().start - sourceBase;
+    source.erase(0, drop);
+    sourceBase += drop;
+}
+
+void TokenStream::parse_number(Token& tok, char ch)
+{   // digits [. digits] [(e|E) [+|-] digits], converted with from_chars so the
+    // value does not depend on the stream's locale
+    auto& text = tok.str;
+    text.assign(1, ch);
+    const auto read_digits = [&] {
+        while (next_char(ch)) {
+            if (!std::isdigit(uchar(ch))) {
+                put_back();
+                break;
+            }
+            text += ch;
+        }
+    };
 
-Token TokenStream::identifier_to_token(const std::string& str) const
-{
-    const auto found = strTokens.find(str);
-    if (found != cend(strTokens))
-        return { found->second };
-    return { Kind::String, str };
+    read_digits();
+    if (text.front() != '.' && next_char(ch)) {
+        if (ch == '.') {
+            text += ch;
+            read_digits();
+        }
+        else
+            put_back();
+    }
+    if (text == ".")
+        error("Bad Token .");
+
+    if (next_char(ch)) {  // an e only starts an exponent if a digit or sign follows, 2e is 2*e
+        const auto next = input->peek();
+        if ((ch == 'e' || ch == 'E') && (std::isdigit(next) || next == '+' || next == '-')) {
+            text += ch;
+            next_char(ch);
+            text += ch;
+            if (ch == '+' || ch == '-') {
+                if (!std::isdigit(input->peek()))
+                    error("Invalid number ", text);
+            }
+            read_digits();
+        }
+        else
+            put_back();
+    }
+
+    const auto res = std::from_chars(text.data(), text.data() + text.size(), tok.num);
+    if (res.ec == std::errc::result_out_of_range)
+        tok.num = std::strtod(text.c_str(), nullptr);  // inf or 0 like operator>>
+}
+
+static Kind keyword_kind(const std::string& str) noexcept
+{   // there are only a handful of short keywords, so length and first
+    // character rule out almost every identifier without a comparison
+    switch (str.size()) {
+    case 2:
+        if (str[0] == 'f' && str[1] == 'n')
+            return Kind::FuncDef;
+        break;
+    case 3:
+        switch (str[0]) {
+        case 'd':
+            if (str == "div") return Kind::FloorDiv;
+            if (str == "del") return Kind::Delete;
+            break;
+        case 'm':
+            if (str == "mod") return Kind::Mod;
+            break;
+        case 'f':
+            if (str == "for") return Kind::For;
+            break;
+        }
+        break;
+    }
+    return Kind::String;
+}
+
+void TokenStream::parse_identifier(Token& tok, char ch)
+{   // the identifier is read straight into its slot of the token ring, whose
+    // buffers are reused from token to token, so lexing it normally allocates nothing
+    if (std::isalpha(uchar(ch)) || ch == '_') {
+        tok.str.assign(1, ch);
+        while (next_char(ch) && (std::isalnum(uchar(ch)) || ch == '_'))
+            tok.str += ch;
+        put_back();
+        tok.kind = keyword_kind(tok.str);
+        if (tok.kind != Kind::String)
+            tok.str.clear();
+        return;
+    }
+    error("Bad Token ", ch);
 }
 
 void TokenStream::cleanup()
@@ -134,4 +280,11 @@ void TokenStream::cleanup()
         delete input;
         ownsInput = false;
     }
+    emit(ring[0], Kind::End);
+    ring[0].start = 0;
+    pos = 0;
+    lexed = 1;
+    source.clear();
+    sourceBase = 0;
+    capturing = false;
 }
\ No newline at end of file
@@ -0,0 +1,223 @@
+#include "linalg.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+
+namespace {
+
+// 64 x 64 complex elements = 64 KiB, three blocks fit into L2
+constexpr std::size_t blockSize{ 64 };
+
+std::string dims(const Matrix& m)
+{
+    return std::to_string(m.rows()) + "x" + std::to_string(m.cols());
+}
+
+void check_same_dims(const Matrix& left, const Matrix& right)
+{
+    if (left.rows() != right.rows() || left.cols() != right.cols())
+        throw std::runtime_error{ "Matrix dimensions differ (" + dims(left) + " and " + dims(right) + ")" };
+}
+
+void check_square(const Matrix& m)
+{
+    if (!m.is_square())
+        throw std::runtime_error{ "Expected a square matrix, not " + dims(m) };
+}
+
+// y += a * x
+void axpy(const Complex& a, const Complex* x, Complex* y, std::size_t n) noexcept
+{
+    const auto xs = reinterpret_cast<const double*>(x);
+    const auto ys = reinterpret_cast<double*>(y);
+    const auto re = a.real();
+    const auto im = a.imag();
+    for (std::size_t j = 0; j < n; ++j) {
+        const auto xr = xs[2 * j];
+        const auto xi = xs[2 * j + 1];
+        ys[2 * j] += re * xr - im * xi;
+        ys[2 * j + 1] += re * xi + im * xr;
+    }
+}
+
+void scale_row(const Complex& a, Complex* y, std::size_t n) noexcept
+{
+    for (std::size_t j = 0; j < n; ++j)
+        y[j] *= a;
+}
+
+}   // anonymous namespace
+
+Matrix add(const Matrix& left, const Matrix& right)
+{
+    check_same_dims(left, right);
+    auto res = left;
+    for (std::size_t i = 0; i < res.rows(); ++i)
+        axpy(1, right.row(i), res.row(i), res.cols());
+    return res;
+}
+
+Matrix sub(const Matrix& left, const Matrix& right)
+{
+    check_same_dims(left, right);
+    auto res = left;
+    for (std::size_t i = 0; i < res.rows(); ++i)
+        axpy(-1, right.row(i), res.row(i), res.cols());
+    return res;
+}
+
+Matrix scale(const Matrix& m, const Complex& factor)
+{
+    auto res = m;
+    for (std::size_t i = 0; i < res.rows(); ++i)
+        scale_row(factor, res.row(i), res.cols());
+    return res;
+}
+
+Matrix transpose(const Matrix& m)
+{
+    Matrix res{ m.cols(), m.rows() };
+    for (std::size_t i = 0; i < m.rows(); ++i) {
+        for (std::size_t j = 0; j < m.cols(); ++j)
+            res(j, i) = m(i, j);
+    }
+    return res;
+}
+
+Matrix multiply(const Matrix& left, const Matrix& right)
+{
+    if (left.cols() != right.rows())
+        throw std::runtime_error{ "Cannot multiply a " + dims(left) + " by a " + dims(right) + " matrix" };
+
+    // row i of the result accumulates left(i, k) * row k of right, block by block
+    Matrix res{ left.rows(), right.cols() };
+    for (std::size_t i0 = 0; i0 < left.rows(); i0 += blockSize) {
+        const auto i1 = std::min(i0 + blockSize, left.rows());
+        for (std::size_t k0 = 0; k0 < left.cols(); k0 += blockSize) {
+            const auto k1 = std::min(k0 + blockSize, left.cols());
+            for (std::size_t j0 = 0; j0 < right.cols(); j0 += blockSize) {
+                const auto n = std::min(blockSize, right.cols() - j0);
+                for (std::size_t i = i0; i < i1; ++i) {
+                    for (std::size_t k = k0; k < k1; ++k)
+                        axpy(left(i, k), right.row(k) + j0, res.row(i) + j0, n);
+                }
+            }
+        }
+    }
+    return res;
+}
+
+List multiply(const Matrix& m, ListView vec)
+{
+    if (m.cols() != vec.size())
+        throw std::runtime_error{ "Cannot multiply a " + dims(m) + " matrix by a list of "
+                                  + std::to_string(vec.size()) + " elements" };
+    List res(m.rows());
+    for (std::size_t i = 0; i < m.rows(); ++i) {
+        Complex sum;
+        for (std::size_t k = 0; k < m.cols(); ++k)
+            sum += m(i, k) * vec[k];
+        res[i] = sum;
+    }
+    return res;
+}
+
+Matrix matrix_pow(const Matrix& m, std::int64_t exp)
+{
+    check_square(m);
+    auto base = exp < 0 ? inverse(m) : m;
+    auto n = exp < 0 ? 0 - static_cast<std::uint64_t>(exp) : static_cast<std::uint64_t>(exp);
+    auto res = Matrix::identity(m.rows());
+    for (; n; n >>= 1) {
+        if (n & 1)
+            res = multiply(res, base);
+        if (n > 1)
+            base = multiply(base, base);
+    }
+    return res;
+}
+
+LU::LU(Matrix m)
+    : lu{ std::move(m) }, perm(lu.rows())
+{
+    check_square(lu);
+    const auto n = lu.rows();
+    for (std::size_t i = 0; i < n; ++i)
+        perm[i] = i;
+
+    for (std::size_t k = 0; k < n; ++k) {
+        auto pivot = k;
+        for (std::size_t i = k + 1; i < n; ++i) {
+            if (std::abs(lu(i, k)) > std::abs(lu(pivot, k)))
+                pivot = i;
+        }
+        if (lu(pivot, k) == Complex{}) {
+            singular = true;
+            continue;
+        }
+        if (pivot != k) {
+            std::swap_ranges(lu.row(k), lu.row(k) + n, lu.row(pivot));
+            std::swap(perm[k], perm[pivot]);
+            oddPermutation = !oddPermutation;
+        }
+        for (std::size_t i = k + 1; i < n; ++i) {
+            const auto l = lu(i, k) / lu(k, k);
+            lu(i, k) = l;
+            axpy(-l, lu.row(k) + k + 1, lu.row(i) + k + 1, n - k - 1);
+        }
+    }
+}
+
+Matrix LU::solve(const Matrix& b) const
+{
+    const auto n = lu.rows();
+    if (b.rows() != n)
+        throw std::runtime_error{ "Cannot solve a " + dims(lu) + " system for a " + dims(b) + " right-hand side" };
+    if (singular)
+        throw std::runtime_error{ "Matrix is singular" };
+
+    // whole rows of b are updated at once, which solves for all columns together
+    const auto m = b.cols();
+    Matrix x{ n, m };
+    for (std::size_t i = 0; i < n; ++i)
+        std::copy_n(b.row(perm[i]), m, x.row(i));
+    for (std::size_t i = 0; i < n; ++i) {
+        for (std::size_t k = 0; k < i; ++k)
+            axpy(-lu(i, k), x.row(k), x.row(i), m);
+    }
+    for (std::size_t i = n; i-- > 0; ) {
+        for (std::size_t k = i + 1; k < n; ++k)
+            axpy(-lu(i, k), x.row(k), x.row(i), m);
+        scale_row(1.0 / lu(i, i), x.row(i), m);
+    }
+    return x;
+}
+
+List LU::solve(ListView b) const
+{
+    Matrix column{ b.size(), 1 };
+    std::copy(b.begin(), b.end(), column.row(0));
+    return solve(column).elements();
+}
+
+Complex LU::determinant() const noexcept
+{
+    if (singular)
+        return 0;
+    Complex det{ oddPermutation ? -1.0 : 1.0 };
+    for (std::size_t i = 0; i < lu.rows(); ++i)
+        det *= lu(i, i);
+    return det;
+}
+
+Matrix inverse(const Matrix& m)
+{
+    return LU{ m }.solve(Matrix::identity(m.rows()));
+}
+
+Complex determinant(const Matrix& m)
+{
+    return LU{ m }.determinant();
+}
@@ -1,8 +1,13 @@
 #include "math_util.hpp"
 
+#include <algorithm>
+#include <array>
 #include <cmath>
-#include <numeric>
+#include <limits>
 #include <stdexcept>
+#include <vector>
+
+#include "parallel.hpp"
 
 using std::runtime_error;
 
@@ -40,21 +45,57 @@ Complex safe_mod(const Complex& left, const Complex& right)
     return safe_mod(static_cast<long>(ltrunc), static_cast<long>(rtrunc));
 }
 
+namespace {
+    constexpr int maxFactorial{ 170 };  // 171! does not fit into a double
+
+    constexpr std::array<double, maxFactorial + 1> make_factorials()
+    {
+        std::array<double, maxFactorial + 1> table{};
+        table[0] = 1;
+        for (int i = 1; i <= maxFactorial; ++i)
+            table[i] = table[i - 1] * i;
+        return table;
+    }
+
+    constexpr auto factorials = make_factorials();
+}
+
 double factorial(int n)
 {
     if (n < 0) throw runtime_error{ "Factorial not defined for negative numbers" };
-    double ret{ 1 };
-    for (int i = 2; i <= n; ++i)
-        ret *= i;
-    return ret;
+    return n <= maxFactorial ? factorials[n] : std::numeric_limits<double>::infinity();
 }
 
 Complex factorial(const Complex& num)
 {
-    auto trunc = std::trunc(num.real());
-    if (num.imag() || trunc < 0 || trunc != num.real())
-        throw runtime_error{ "Factorial only defined for natural numbers (and zero)" };
-    return factorial(static_cast<int>(trunc));
+    const auto trunc = std::trunc(num.real());
+    if (num.imag() || trunc != num.real())
+        return tgamma(num + 1.0);
+    if (trunc < 0)
+        throw runtime_error{ "Factorial not defined for negative integers" };
+    return trunc <= maxFactorial ? factorials[static_cast<int>(trunc)] : std::numeric_limits<double>::infinity();
+}
+
+Complex tgamma(const Complex& z)
+{   // Lanczos approximation (g = 7, n = 9), reflection formula for Re(z) < 0.5
+    if (!z.imag())
+        return std::tgamma(z.real());
+    if (z.real() < 0.5)
+        return pi / (std::sin(pi * z) * tgamma(1.0 - z));
+
+    constexpr double g{ 7 };
+    constexpr double coef[]{
+        0.99999999999980993, 676.5203681218851, -1259.1392167224028,
+        771.32342877765313, -176.61502916214059, 12.507343278686905,
+        -0.13857109526572012, 9.9843695780195716e-6, 1.5056327351493116e-7
+    };
+    const auto x = z - 1.0;
+    Complex sum{ coef[0] };
+    for (int i = 1; i < 9; ++i)
+        sum += coef[i] / (x + static_cast<double>(i));
+    const auto t = x + g + 0.5;
+    // t^(x+0.5) * e^-t computed as one exponential, so it only overflows if the result does
+    return std::sqrt(2 * pi) * std::exp((x + 0.5) * std::log(t) - t) * sum;
 }
 
 Complex impedance_parallel(const Complex& R1, const Complex& R2)
@@ -64,55 +105,257 @@ Complex impedance_parallel(const Complex& R1, const Complex& R2)
     return R1 * R2 / (R1 + R2);
 }
 
+Complex int_pow(Complex base, unsigned long long exp)
+{   // exponentiation by squaring, O(log exp) multiplications
+    Complex res{ 1 };
+    while (exp) {
+        if (exp & 1)
+            res *= base;
+        exp >>= 1;
+        if (exp)
+            base *= base;
+    }
+    return res;
+}
+
 Complex pretty_pow(const Complex& base, const Complex& exp)
 {   // I like i^3 to show -i and not -1.83697e-16-i or
     // (-3)^3 to show -27 and not -27+9.91964e-15i
-    if (!exp.imag() && exp.real() > 1) {
-        Complex res{ 1 };
-        auto e = static_cast<unsigned>(exp.real());
-        if (e == exp.real()) {
-            for (unsigned i = 0; i < e; ++i)
-                res *= base;
-            return res;
-        }
+    constexpr double maxExactInt{ 9007199254740992.0 };  // 2^53
+    const auto e = exp.real();
+    if (!exp.imag() && e == std::trunc(e) && std::abs(e) <= maxExactInt) {
+        if (e >= 0)
+            return int_pow(base, static_cast<unsigned long long>(e));
+        if (!is_zero(base))
+            return 1.0 / int_pow(base, static_cast<unsigned long long>(-e));
     }
     return std::pow(base, exp);
 }
 
-std::size_t len(const List& list) noexcept
+Complex literal_pow(const Complex& base, double exp)
 {
-    return list.size();
+    if (exp == 2)
+        return sqr(base);
+    if (exp == 3)
+        return sqr(base) * base;
+    if (exp == 0.5)
+        return std::sqrt(base);
+    return pretty_pow(base, exp);
 }
 
-Complex sum(const List& list)
+std::size_t len(ListSource list)
 {
-    return std::accumulate(cbegin(list), cend(list), Complex{});
+    return list.size();
 }
 
-Complex sqr_sum(const List& list)
+namespace {
+    // Reductions keep several independent accumulators (lanes) so consecutive
+    // additions do not wait on each other and the compiler can vectorize them.
+    constexpr std::size_t lanes{ 4 };
+    constexpr std::size_t pairwiseBlock{ 128 };  // below this the lanes sum directly
+
+    // Long lists are cut into chunks of a fixed size whose partial results are
+    // combined in a fixed tree, so the result does not depend on how many
+    // threads reduced the chunks.
+    constexpr std::size_t chunkSize{ 1 << 16 };
+
+    struct Identity {
+        Complex operator()(const Complex& c) const noexcept { return c; }
+    };
+
+    struct SquareDistance {  // sqr(c - mean) without the inf/nan handling of complex multiplication
+        Complex operator()(const Complex& c) const noexcept
+        {
+            const auto re = c.real() - mean.real();
+            const auto im = c.imag() - mean.imag();
+            return { re * re - im * im, 2 * re * im };
+        }
+        Complex mean;
+    };
+
+    template<class F>
+    Complex pairwise_sum(const Complex* data, std::size_t n, F f)
+    {
+        if (n > pairwiseBlock) {
+            const auto half = n / 2 / lanes * lanes;
+            return pairwise_sum(data, half, f) + pairwise_sum(data + half, n - half, f);
+        }
+        double re[lanes]{}, im[lanes]{};
+        std::size_t i{};
+        for (; i + lanes <= n; i += lanes) {
+            for (std::size_t k = 0; k < lanes; ++k) {
+                const auto c = f(data[i + k]);
+                re[k] += c.real();
+                im[k] += c.imag();
+            }
+        }
+        for (std::size_t k = 0; i < n; ++i, ++k) {
+            const auto c = f(data[i]);
+            re[k] += c.real();
+            im[k] += c.imag();
+        }
+        for (auto width = lanes / 2; width; width /= 2) {
+            for (std::size_t k = 0; k < width; ++k) {
+                re[k] += re[k + width];
+                im[k] += im[k + width];
+            }
+        }
+        return { re[0], im[0] };
+    }
+
+    struct Neumaier {
+        void add(double x) noexcept
+        {
+            const auto t = sum + x;
+            comp += std::abs(sum) >= std::abs(x) ? (sum - t) + x : (x - t) + sum;
+            sum = t;
+        }
+        void add(const Neumaier& other) noexcept
+        {
+            add(other.sum);
+            add(other.comp);
+        }
+        double result() const noexcept { return sum + comp; }
+
+        double sum{};
+        double comp{};
+    };
+
+    struct CompensatedSum {
+        void add(const CompensatedSum& other) noexcept
+        {
+            re.add(other.re);
+            im.add(other.im);
+        }
+        Complex result() const noexcept { return { re.result(), im.result() }; }
+
+        Neumaier re;
+        Neumaier im;
+    };
+
+    template<class F>
+    CompensatedSum compensated_sum(const Complex* data, std::size_t n, F f)
+    {
+        Neumaier re[lanes]{}, im[lanes]{};
+        std::size_t i{};
+        for (; i + lanes <= n; i += lanes) {
+            for (std::size_t k = 0; k < lanes; ++k) {
+                const auto c = f(data[i + k]);
+                re[k].add(c.real());
+                im[k].add(c.imag());
+            }
+        }
+        for (std::size_t k = 0; i < n; ++i, ++k) {
+            const auto c = f(data[i]);
+            re[k].add(c.real());
+            im[k].add(c.imag());
+        }
+        for (std::size_t k = 1; k < lanes; ++k) {
+            re[0].add(re[k]);
+            im[0].add(im[k]);
+        }
+        return { re[0], im[0] };
+    }
+
+    Complex combine(const Complex* partial, std::size_t n)
+    {
+        if (n == 1)
+            return partial[0];
+        const auto half = n / 2;
+        return combine(partial, half) + combine(partial + half, n - half);
+    }
+
+    CompensatedSum combine(const CompensatedSum* partial, std::size_t n)
+    {
+        auto total = partial[0];
+        for (std::size_t i = 1; i < n; ++i)
+            total.add(partial[i]);
+        return total;
+    }
+
+    Complex result_of(const Complex& c) noexcept { return c; }
+    Complex result_of(const CompensatedSum& c) noexcept { return c.result(); }
+
+    template<class Kernel>
+    Complex reduce_chunks(ListView list, const ReduceOptions& opts, Kernel kernel)
+    {
+        const auto n = list.size();
+        if (n <= chunkSize)
+            return result_of(kernel(list.data(), n));
+
+        using Partial = decltype(kernel(list.data(), n));
+        std::vector<Partial> partial((n + chunkSize - 1) / chunkSize);
+        const auto reduce_chunk = [&](std::size_t c) {
+            const auto first = c * chunkSize;
+            partial[c] = kernel(list.data() + first, std::min(chunkSize, n - first));
+        };
+
+        const auto threads = opts.threads ? opts.threads : hardware_threads();
+        if (n >= opts.parallelThreshold && threads > 1)
+            parallel_for(partial.size(), threads, reduce_chunk);
+        else {
+            for (std::size_t c = 0; c < partial.size(); ++c)
+                reduce_chunk(c);
+        }
+        return result_of(combine(partial.data(), partial.size()));
+    }
+
+    template<class Kernel>
+    Complex reduce_chunks(ListStream& stream, Kernel kernel)
+    {   // chunks are read into one reused buffer and cut exactly like stored lists,
+        // so both give identical results
+        List chunk(std::min(chunkSize, stream.size()));
+        using Partial = decltype(kernel(chunk.data(), 0));
+        std::vector<Partial> partial;
+        stream.restart();
+        while (const auto n = stream.read(chunk.data(), chunk.size()))
+            partial.push_back(kernel(chunk.data(), n));
+        if (partial.empty())
+            return result_of(kernel(chunk.data(), 0));
+        return result_of(combine(partial.data(), partial.size()));
+    }
+
+    template<class Kernel>
+    Complex reduce_source(ListSource list, const ReduceOptions& opts, Kernel kernel)
+    {
+        if (const auto stream = list.as_stream())
+            return reduce_chunks(*stream, kernel);
+        return reduce_chunks(list.view(), opts, kernel);
+    }
+
+    template<class F>
+    Complex reduce(ListSource list, const ReduceOptions& opts, F f)
+    {
+        if (opts.summation == Summation::Compensated)
+            return reduce_source(list, opts, [f](const Complex* data, std::size_t n) { return compensated_sum(data, n, f); });
+        return reduce_source(list, opts, [f](const Complex* data, std::size_t n) { return pairwise_sum(data, n, f); });
+    }
+}
+
+Complex sum(ListSource list, const ReduceOptions& opts)
 {
-    const auto acc_squared = [](auto sum, auto next)
-    { return sum + sqr(next); };
-    return std::accumulate(cbegin(list), cend(list), Complex{}, acc_squared);
+    return reduce(list, opts, Identity{});
 }
 
-Complex avg(const List& list)
+Complex sqr_sum(ListSource list, const ReduceOptions& opts)
 {
-    return sum(list) / static_cast<double>(len(list));
+    return reduce(list, opts, SquareDistance{});
 }
 
-Complex standard_deviation(const List& list)
+Complex avg(ListSource list, const ReduceOptions& opts)
 {
-    const auto acc_distance_squared = [a = avg(list)](auto sum, auto next) 
-    { return sum + sqr(next - a); };
+    return sum(list, opts) / static_cast<double>(len(list));
+}
 
-    const auto s_sqr = std::accumulate(cbegin(list), cend(list), Complex{}, acc_distance_squared)
+Complex standard_deviation(ListSource list, const ReduceOptions& opts)
+{
+    const auto s_sqr = reduce(list, opts, SquareDistance{ avg(list, opts) })
                        / static_cast<double>(len(list) - 1);
 
     return std::sqrt(s_sqr);
 }
 
-Complex standard_uncertainty(const List& list)
+Complex standard_uncertainty(ListSource list, const ReduceOptions& opts)
 {
-    return standard_deviation(list) / std::sqrt(len(list));
+    return standard_deviation(list, opts) / std::sqrt(len(list));
 }
@@ -0,0 +1,220 @@
+#include "vecmath.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+namespace {
+
+constexpr std::size_t blockSize{ 128 };
+
+// Adding 1.5 * 2^52 rounds to an integer, which then sits in the low bits of the mantissa
+constexpr double shifter{ 0x1.8p52 };
+
+constexpr double log2e{ 0x1.71547652b82fep0 };
+constexpr double twoOverPi{ 0x1.45f306dc9c883p-1 };
+// ln 2 and pi/2 split into parts with trailing zeros, so k * hi is exact (fdlibm)
+constexpr double ln2Hi{ 0x1.62e42feep-1 };
+constexpr double ln2Lo{ 0x1.a39ef35793c76p-33 };
+constexpr double pio2[]{ 0x1.921fb544p0, 0x1.0b4611a6p-34, 0x1.3198a2ep-69, 0x1.b839a252049c1p-104 };
+
+constexpr double trigLimit{ 1e5 };
+constexpr double expLimit{ 708 };
+
+std::uint64_t to_bits(double d) noexcept
+{
+    std::uint64_t u;
+    std::memcpy(&u, &d, sizeof u);
+    return u;
+}
+
+double from_bits(std::uint64_t u) noexcept
+{
+    double d;
+    std::memcpy(&d, &u, sizeof d);
+    return d;
+}
+
+constexpr double factorial(int n) noexcept
+{
+    double f{ 1 };
+    for (int i = 2; i <= n; ++i)
+        f *= i;
+    return f;
+}
+
+// Taylor coefficients, truncated where the next term is below an ULP on the reduced range
+constexpr double expCoeffs[]{ 1, 1, 1 / factorial(2), 1 / factorial(3), 1 / factorial(4), 1 / factorial(5),
+    1 / factorial(6), 1 / factorial(7), 1 / factorial(8), 1 / factorial(9), 1 / factorial(10),
+    1 / factorial(11), 1 / factorial(12), 1 / factorial(13) };
+constexpr double sinCoeffs[]{ -1 / factorial(3), 1 / factorial(5), -1 / factorial(7), 1 / factorial(9),
+    -1 / factorial(11), 1 / factorial(13), -1 / factorial(15), 1 / factorial(17) };
+constexpr double cosCoeffs[]{ 1 / factorial(4), -1 / factorial(6), 1 / factorial(8), -1 / factorial(10),
+    1 / factorial(12), -1 / factorial(14), 1 / factorial(16) };
+// 2 atanh(s) = 2s + s (2/3 s^2 + 2/5 s^4 + ...)
+constexpr double atanhCoeffs[]{ 2. / 3, 2. / 5, 2. / 7, 2. / 9, 2. / 11, 2. / 13, 2. / 15, 2. / 17, 2. / 19,
+    2. / 21, 2. / 23 };
+
+template<std::size_t N>
+double horner(double x, const double (&c)[N]) noexcept
+{
+    auto p = c[N - 1];
+    for (auto i = N - 1; i-- > 0; )
+        p = p * x + c[i];
+    return p;
+}
+
+template<bool Cos>
+void real_sincos(const double* x, double* y, std::size_t n) noexcept
+{   // x = k pi/2 + r with |r| <= pi/4, the quadrant k mod 4 picks sin or cos of r and the sign
+    for (std::size_t i = 0; i < n; ++i) {
+        const auto t = x[i] * twoOverPi + shifter;
+        const auto k = t - shifter;
+        const auto r = (((x[i] - k * pio2[0]) - k * pio2[1]) - k * pio2[2]) - k * pio2[3];
+        const auto z = r * r;
+        const auto s = r + r * z * horner(z, sinCoeffs);
+        const auto c = 1 - 0.5 * z + z * z * horner(z, cosCoeffs);
+        const auto quadrant = to_bits(t) + (Cos ? 1 : 0);  // cos x = sin(x + pi/2)
+        // selected with bit masks instead of branches, which vectorizes on plain SSE2
+        const auto odd = 0 - (quadrant & 1);
+        const auto v = (to_bits(c) & odd) | (to_bits(s) & ~odd);
+        y[i] = from_bits(v ^ ((quadrant & 2) << 62));
+    }
+}
+
+bool trig_range(double x) noexcept
+{
+    return std::abs(x) <= trigLimit;
+}
+
+// Runs kernel over the real parts of a block and keeps its result for real
+// elements within range; the others go through scalar
+template<class Kernel, class InRange, class Scalar>
+void map_real(const Complex* in, Complex* out, std::size_t n, Kernel kernel, InRange inRange, Scalar scalar)
+{
+    alignas(64) double x[blockSize];
+    alignas(64) double y[blockSize];
+    for (std::size_t first = 0; first < n; first += blockSize) {
+        const auto m = std::min(blockSize, n - first);
+        for (std::size_t i = 0; i < m; ++i)
+            x[i] = in[first + i].real();
+        kernel(x, y, m);
+        for (std::size_t i = 0; i < m; ++i) {
+            const auto& c = in[first + i];
+            out[first + i] = c.imag() == 0 && inRange(x[i]) ? Complex{ y[i] } : scalar(c);
+        }
+    }
+}
+
+}   // anonymous namespace
+
+void real_sin(const double* x, double* y, std::size_t n) noexcept
+{
+    real_sincos<false>(x, y, n);
+}
+
+void real_cos(const double* x, double* y, std::size_t n) noexcept
+{
+    real_sincos<true>(x, y, n);
+}
+
+void real_exp(const double* x, double* y, std::size_t n) noexcept
+{   // e^x = 2^k e^r with |r| <= ln(2)/2, 2^k is assembled in the exponent bits
+    for (std::size_t i = 0; i < n; ++i) {
+        const auto t = x[i] * log2e + shifter;
+        const auto k = t - shifter;
+        const auto r = (x[i] - k * ln2Hi) - k * ln2Lo;
+        y[i] = horner(r, expCoeffs) * from_bits((to_bits(t) - to_bits(shifter) + 1023) << 52);
+    }
+}
+
+void real_log(const double* x, double* y, std::size_t n) noexcept
+{   // x = 2^e m with m in [sqrt(1/2), sqrt(2)), ln m = 2 atanh(s) with s = (m - 1)/(m + 1) (musl)
+    for (std::size_t i = 0; i < n; ++i) {
+        const auto u = to_bits(x[i]) + (0x3ff0000000000000 - 0x3fe6a09e00000000);
+        const auto e = from_bits(0x4330000000000000 | (u >> 52)) - (0x1p52 + 1023);
+        const auto m = from_bits((u & 0x000fffffffffffff) + 0x3fe6a09e00000000);
+        const auto f = m - 1;
+        const auto s = f / (2 + f);
+        const auto z = s * s;
+        const auto log1pf = f - s * (f - z * horner(z, atanhCoeffs));
+        y[i] = e * ln2Hi + (log1pf + e * ln2Lo);
+    }
+}
+
+void vec_sin(const Complex* in, Complex* out, std::size_t n)
+{
+    map_real(in, out, n, real_sin, trig_range, [](const Complex& c) { return std::sin(c); });
+}
+
+void vec_cos(const Complex* in, Complex* out, std::size_t n)
+{
+    map_real(in, out, n, real_cos, trig_range, [](const Complex& c) { return std::cos(c); });
+}
+
+void vec_log(const Complex* in, Complex* out, std::size_t n)
+{
+    map_real(in, out, n, real_log,
+             [](double x) { return x >= 0x1p-1022 && x <= 0x1.fffffffffffffp1023; },
+             [](const Complex& c) { return std::log(c); });
+}
+
+void vec_sqrt(const Complex* in, Complex* out, std::size_t n)
+{
+    map_real(in, out, n,
+             [](const double* x, double* y, std::size_t m) {
+                 for (std::size_t i = 0; i < m; ++i)
+                     y[i] = std::sqrt(std::max(x[i], 0.));
+             },
+             [](double x) { return x >= 0; },
+             [](const Complex& c) { return std::sqrt(c); });
+}
+
+void vec_exp(const Complex* in, Complex* out, std::size_t n)
+{   // split into real and imaginary parts, so complex blocks use the kernels too
+    alignas(64) double re[blockSize], im[blockSize];
+    alignas(64) double mag[blockSize], cosIm[blockSize], sinIm[blockSize];
+    for (std::size_t first = 0; first < n; first += blockSize) {
+        const auto m = std::min(blockSize, n - first);
+        auto real = true;
+        for (std::size_t i = 0; i < m; ++i) {
+            re[i] = in[first + i].real();
+            im[i] = in[first + i].imag();
+            real &= im[i] == 0;
+        }
+        real_exp(re, mag, m);
+        if (real) {
+            std::fill_n(cosIm, m, 1.);
+            std::fill_n(sinIm, m, 0.);
+        }
+        else {
+            real_cos(im, cosIm, m);
+            real_sin(im, sinIm, m);
+        }
+        for (std::size_t i = 0; i < m; ++i) {
+            out[first + i] = std::abs(re[i]) <= expLimit && trig_range(im[i])
+                ? Complex{ mag[i] * cosIm[i], mag[i] * sinIm[i] }
+                : std::exp(Complex{ re[i], im[i] });
+        }
+    }
+}
+
+void vec_abs(const Complex* in, Complex* out, std::size_t n)
+{   // sqrt(re^2 + im^2) where the squares neither overflow nor lose digits to underflow
+    alignas(64) double y[blockSize];
+    for (std::size_t first = 0; first < n; first += blockSize) {
+        const auto m = std::min(blockSize, n - first);
+        for (std::size_t i = 0; i < m; ++i) {
+            const auto re = in[first + i].real();
+            const auto im = in[first + i].imag();
+            y[i] = im == 0 ? std::abs(re) : std::sqrt(re * re + im * im);
+        }
+        for (std::size_t i = 0; i < m; ++i) {
+            const auto re = in[first + i].real();
+            const auto im = in[first + i].imag();
+            const auto safe = im == 0 || (std::abs(re) < 1e150 && std::abs(im) < 1e150 && y[i] >= 1e-145);
+            out[first + i] = safe ? Complex{ y[i] } : std::abs(in[first + i]);
+        }
+    }
+}
@@ -0,0 +1,59 @@
+#include "catch.hpp"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <string>
+
+#include "Parser.hpp"
+#include "SymbolTable.hpp"
+
+// Replacing the global allocation functions affects the whole binary, so these
+// tests are built into their own executable, AllocationTests
+
+static std::atomic<std::size_t> allocations{ 0 };
+
+void* operator new(std::size_t size)
+{
+    ++allocations;
+    if (const auto p = std::malloc(size ? size : 1))
+        return p;
+    throw std::bad_alloc{};
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+    ++allocations;
+    return std::malloc(size ? size : 1);
+}
+
+void operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void* p, const std::nothrow_t&) noexcept
+{
+    std::free(p);
+}
+
+TEST_CASE("Scalar built-in calls allocate nothing", "[Builtin]") {
+    SymbolTable table;
+    Parser parser{ table };
+    table.set_var("x", 0.5);
+    const std::string calls{ "sin(cos(x)) + hypot(x, atan2(x, 1)) - abs(exp(-x))" };
+    REQUIRE_NOTHROW(parser.parse(calls));
+    const auto result = parser.result();
+
+    // the first parse sizes the parser's buffers, evaluating again allocates nothing
+    const auto before = allocations.load();
+    parser.parse(calls);
+    const auto allocated = allocations.load() - before;  // REQUIRE allocates itself
+    REQUIRE(allocated == 0);
+    REQUIRE(parser.result() == result);
+}
@@ -0,0 +1,49 @@
+#include "catch.hpp"
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "Batch.hpp"
+#include "Parser.hpp"
+#include "SymbolTable.hpp"
+
+TEST_CASE("Batch mode", "[Batch]") {
+    SymbolTable table;
+    Parser parser{ table };
+    std::istringstream in{ "1 + 1\nundefined\n2 * ans\n[1, 2] * 2\nsqrt(\nfoo(1)\nx = 3\nx\n" };
+    std::ostringstream os, err;
+    {
+        OutputBuffer out{ os };
+        run_batch(parser, in, out, err);
+    }
+
+    // one line per result on stdout, one line per error on stderr
+    REQUIRE(os.str() == "2\n4\n[2, 4]\n3\n3\n");
+    REQUIRE(err.str() == "Variable undefined is undefined\nUnexpected Token END\nFunction foo is undefined\n");
+}
+
+TEST_CASE("Running files", "[Batch]") {
+    const std::vector<std::string> paths{ "run_files_a.dc", "run_files_missing.dc", "run_files_b.dc", "run_files_c.dc" };
+    std::ofstream{ paths[0] } << "x = 2\nx * 3\n[x, 1]\n";
+    std::ofstream{ paths[2] } << "y = 5\ny + 1\nundefined + 1\ny\n";  // stops at the error
+    std::ofstream{ paths[3] } << "x\n";                                  // sessions do not share symbols
+
+    for (unsigned jobs : { 1u, 3u }) {
+        std::ostringstream os, err;
+        std::size_t failed;
+        {
+            OutputBuffer out{ os };
+            failed = run_files(paths, jobs, out, err);
+        }
+        REQUIRE(failed == 3);
+        REQUIRE(os.str() == "2\n6\n[2, 1]\n5\n6\n");  // in argument order, up to the errors
+        REQUIRE(err.str() == "run_files_missing.dc: Cannot open file run_files_missing.dc\n"
+                             "run_files_b.dc: Variable undefined is undefined\n"
+                             "run_files_c.dc: Variable x is undefined\n");
+    }
+    for (const auto& path : paths)
+        std::remove(path.c_str());
+}
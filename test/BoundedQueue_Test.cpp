@@ -0,0 +1,22 @@
+#include "catch.hpp"
+#include "BoundedQueue.hpp"
+
+#include <thread>
+
+TEST_CASE("BoundedQueue test", "[BoundedQueue]") {
+    BoundedQueue<int> queue{ 2 };
+
+    std::thread producer{ [&] {
+        for (int i = 0; i < 1000; ++i)
+            queue.push(i);
+        queue.close();
+    } };
+
+    int expected{};
+    for (int i; queue.pop(i); ++expected)
+        REQUIRE(i == expected);
+    producer.join();
+
+    REQUIRE(expected == 1000);
+    REQUIRE_FALSE(queue.push(42));
+}
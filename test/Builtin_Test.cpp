@@ -0,0 +1,43 @@
+#include "catch.hpp"
+
+#include <cmath>
+
+#include "Builtin.hpp"
+#include "Parser.hpp"
+#include "SymbolTable.hpp"
+
+TEST_CASE("Built-in arity", "[Builtin]") {
+    const Builtin sqr{ [](const Complex& x) { return x * x; }, nullptr };
+    const Builtin diff{ [](const Complex& x, const Complex& y) { return x - y; } };
+    const Builtin count{ [](const Complex*, std::size_t n) { return Complex(static_cast<double>(n)); } };
+    const Complex args[]{ 3, 1, 4 };
+
+    REQUIRE(sqr.arity() == 1);
+    REQUIRE(sqr(args, 1) == Complex{ 9 });
+    REQUIRE(diff(args, 2) == Complex{ 2 });
+    REQUIRE(count(args, 3) == Complex{ 3 });
+    REQUIRE_FALSE(diff.accepts(3));
+    REQUIRE(count.accepts(1));
+    REQUIRE_FALSE(count.accepts(0));
+    REQUIRE_THROWS_WITH(sqr.check_arity("sqr", 2), "sqr expects 1 argument (received 2)");
+    REQUIRE_THROWS_WITH(diff.check_arity("diff", 0), "Invalid empty argument list");
+}
+
+TEST_CASE("Calling built-ins", "[Builtin]") {
+    SymbolTable table;
+    Parser parser{ table };
+
+    REQUIRE_NOTHROW(parser.parse("atan2(1, 1)"));
+    REQUIRE(parser.result() == Complex{ std::atan2(1, 1) });
+    REQUIRE_NOTHROW(parser.parse("hypot(sin(0), hypot(3, 4)) + hypot([6, 8])"));  // lists are spliced
+    REQUIRE(parser.result() == Complex{ 15 });
+    REQUIRE(table.call_func("hypot", { 5, 12 }) == Complex{ 13 });
+    REQUIRE_THROWS_WITH(parser.parse("sin(1, 2)"), "sin expects 1 argument (received 2)");
+    REQUIRE_THROWS(parser.parse("atan2(1)"));
+    REQUIRE_THROWS(parser.parse("atan2(i, 1)"));
+    REQUIRE_THROWS(parser.parse("sin()"));
+    REQUIRE_THROWS(table.call_func("cos", {}));
+    REQUIRE_THROWS(parser.parse("hypot(1, undefined)"));
+    REQUIRE_NOTHROW(parser.parse("hypot(3, 4)"));  // a failed call leaves nothing on the stack
+    REQUIRE(parser.result() == Complex{ 5 });
+}
@@ -0,0 +1,97 @@
+#include "catch.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+#include "Histogram.hpp"
+#include "Parser.hpp"
+#include "SymbolTable.hpp"
+
+TEST_CASE("Histograms", "[Histogram]") {
+    const List data{ 0, 0.5, 1, 1.5, 2, 2.5, 3, 4 };
+
+    const auto bins = data_bins(data, 4);
+    REQUIRE(bins.low == 0);
+    REQUIRE(bins.high == 4);
+    REQUIRE((binned(data, bins, BinStat::Count) == List{ 2, 2, 2, 2 }));
+    REQUIRE((binned(data, bins, BinStat::Sum) == List{ 0.5, 2.5, 4.5, 7 }));
+    REQUIRE((binned(data, bins, BinStat::Mean) == List{ 0.25, 1.25, 2.25, 3.5 }));
+    REQUIRE((bin_centers(bins) == List{ 0.5, 1.5, 2.5, 3.5 }));
+
+    const Bins narrow{ 1, 2, 2 };  // outside values are ignored, the high end is included
+    REQUIRE((binned(data, narrow, BinStat::Count) == List{ 1, 2 }));
+    const auto means = binned(List{ 1, 1.2 }, { 0, 10, 2 }, BinStat::Mean);
+    REQUIRE(means[0] == Complex((1 + 1.2) / 2));
+    REQUIRE(std::isnan(means[1].real()));
+
+    REQUIRE((binned(List{ 3, 3 }, data_bins(List{ 3, 3 }, 1), BinStat::Count) == List{ 2 }));
+    REQUIRE((binned(List{ std::nan(""), 1 }, { 0, 2, 2 }, BinStat::Count) == List{ 0, 1 }));
+    REQUIRE_THROWS(binned(List{ { 1, 1 } }, { 0, 2, 2 }, BinStat::Count));
+    REQUIRE_THROWS(make_bins(data, List{ 0 }));
+    REQUIRE_THROWS(make_bins(data, List{ 2.5 }));
+    REQUIRE_THROWS(make_bins(data, List{ 4, 2, 1 }));
+    REQUIRE_THROWS_WITH(make_bins(data, List{ 10, 0, 1e-320 }), "The range of the bins is too narrow");
+    REQUIRE_THROWS_WITH(data_bins(List{ 0, 1e-320 }, 10), "The range of the bins is too narrow");
+}
+
+namespace {
+    class ViewStream : public ListStream {
+    public:
+        explicit ViewStream(ListView view) : view{ view } { }
+
+        std::size_t size() const override { return view.size(); }
+        void restart() override { pos = 0; }
+        std::size_t read(Complex* out, std::size_t max) override
+        {
+            const auto n = std::min(max, view.size() - pos);
+            std::copy(view.data() + pos, view.data() + pos + n, out);
+            pos += n;
+            return n;
+        }
+
+    private:
+        ListView view;
+        std::size_t pos{};
+    };
+}
+
+TEST_CASE("Parallel histograms", "[Histogram]") {
+    std::mt19937_64 gen{ 3 };
+    std::normal_distribution<double> dist{ 0, 1 };
+    List data(200000);
+    for (auto& c : data)
+        c = dist(gen);  // sums are rounded, identical only when added up in the same order
+
+    const Bins bins{ -3, 3, 37 };
+    ReduceOptions sequential;
+    sequential.threads = 1;
+    const auto counts = binned(data, bins, BinStat::Count, sequential);
+    const auto sums = binned(data, bins, BinStat::Sum, sequential);
+    for (unsigned threads : { 2u, 5u }) {
+        ReduceOptions opts;
+        opts.parallelThreshold = 0;
+        opts.threads = threads;
+        REQUIRE(binned(data, bins, BinStat::Count, opts) == counts);
+        REQUIRE(binned(data, bins, BinStat::Sum, opts) == sums);
+    }
+    ViewStream stream{ data };
+    REQUIRE(binned(stream, bins, BinStat::Count) == counts);
+    REQUIRE(binned(stream, bins, BinStat::Sum) == sums);
+}
+
+TEST_CASE("Histogram functions", "[Histogram]") {
+    SymbolTable table;
+    Parser parser{ table };
+    parser.parse("x = [for k=0, 9 k]");
+    parser.parse("h = hist(x, 2)");
+    REQUIRE((table.list("h") == List{ 5, 5 }));
+    parser.parse("h = binavg(x*2, 2, 0, 10)");
+    REQUIRE((table.list("h") == List{ 2, 8 }));
+    parser.parse("h = binsum(x, 3, 0, 3)");
+    REQUIRE((table.list("h") == List{ 0, 1, 5 }));
+    parser.parse("h = bincenter(x, 3, 0, 3)");
+    REQUIRE((table.list("h") == List{ 0.5, 1.5, 2.5 }));
+    REQUIRE_THROWS(parser.parse("hist(x)"));
+    REQUIRE_THROWS(parser.parse("hist(x, 2, 1)"));
+}
@@ -0,0 +1,52 @@
+#include "catch.hpp"
+
+#include <cstdio>
+#include <fstream>
+
+#include "Import.hpp"
+
+TEST_CASE("CSV import", "[Import]") {
+    const std::string path{ "import_test.csv" };
+    {
+        std::ofstream csv{ path };
+        csv << "time;voltage\n0;1.5\n0.1; -2e3\r\n\n0.2;\"+4\"\n";
+    }
+    REQUIRE((import_csv(path) == List{ 0, 0.1, 0.2 }));
+    REQUIRE((import_csv(path, 2) == List{ 1.5, -2000, 4 }));
+    REQUIRE((import_list(path, 2) == List{ 1.5, -2000, 4 }));
+    REQUIRE_THROWS(import_csv(path, 3));
+    REQUIRE_THROWS(import_csv(path, 0));
+
+    {
+        std::ofstream csv{ path };
+        for (int i = 0; i < 200000; ++i)
+            csv << i << ',' << i * 0.5 << '\n';
+        csv << "1,x\n";
+    }
+    REQUIRE(import_csv(path).size() == 200001);
+    REQUIRE_THROWS_WITH(import_csv(path, 2), path + ":200001: no number in column 2");
+
+    std::remove(path.c_str());
+    REQUIRE_THROWS(import_csv(path));
+}
+
+TEST_CASE("Binary import", "[Import]") {
+    const std::string path{ "import_test.bin" };
+    const unsigned char bytes[]{
+        0, 0, 0, 0, 0, 0, 0xf8, 0x3f,   // 1.5
+        0, 0, 0, 0, 0, 0, 0x00, 0xc0    // -2
+    };
+    {
+        std::ofstream bin{ path, std::ios::binary };
+        bin.write(reinterpret_cast<const char*>(bytes), sizeof bytes);
+    }
+    REQUIRE((import_binary(path) == List{ 1.5, -2 }));
+    REQUIRE((import_list(path) == List{ 1.5, -2 }));
+
+    {
+        std::ofstream bin{ path, std::ios::binary | std::ios::app };
+        bin << 'x';
+    }
+    REQUIRE_THROWS(import_binary(path));
+    std::remove(path.c_str());
+}
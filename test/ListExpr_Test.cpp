@@ -0,0 +1,71 @@
+#include "catch.hpp"
+
+#include <limits>
+
+#include "ListExpr.hpp"
+#include "math_util.hpp"
+
+TEST_CASE("Element-wise list arithmetic", "[ListExpr]") {
+    const List a{ 1, { 2, -1 }, 3, { 0, 4 } };
+    const List b{ 2, 3, { -1, 1 }, 0.5 };
+
+    REQUIRE(apply(ElemOp::Add, Value{ 1 }, Value{ 2 }).num() == Complex(3));
+    REQUIRE_FALSE(apply(ElemOp::Mul, Value{ 1 }, Value{ 2 }).is_list());
+    REQUIRE_THROWS(apply(ElemOp::Div, Value{ 1 }, Value{ 0 }));
+
+    for (const auto op : { ElemOp::Add, ElemOp::Sub, ElemOp::Mul, ElemOp::Div, ElemOp::Pow, ElemOp::Parallel }) {
+        const auto res = apply(op, list_value(a), list_value(b));
+        REQUIRE(res.is_list());
+        const auto elems = to_list(*res.list());
+        REQUIRE(elems.size() == a.size());
+        for (std::size_t i = 0; i < a.size(); ++i)
+            REQUIRE(elems[i] == apply(op, a[i], b[i]));
+    }
+
+    const auto scaled = to_list(*apply(ElemOp::Mul, Value{ 2 }, list_value(a)).list());
+    REQUIRE((scaled == List{ 2, { 4, -2 }, 6, { 0, 8 } }));
+    const auto negated = to_list(*apply(UnaryOp::Neg, list_value(b)).list());
+    REQUIRE((negated == List{ -2, -3, { 1, -1 }, -0.5 }));
+
+    REQUIRE_THROWS(apply(ElemOp::Add, list_value(a), list_value(List{ 1, 2 })));
+    REQUIRE_THROWS(to_list(*apply(ElemOp::Div, list_value(a), Value{ 0 }).list()));
+
+    const auto inf = std::numeric_limits<double>::infinity();
+    const List infs{ { inf, 1 }, { 1, inf } };
+    const auto product = to_list(*apply(ElemOp::Mul, list_value(infs), list_value(infs)).list());
+    REQUIRE(product[0] == infs[0] * infs[0]);
+    REQUIRE(product[1] == infs[1] * infs[1]);
+}
+
+TEST_CASE("List slices", "[ListExpr]") {
+    const List a{ 0, 1, 2, 3, 4, 5, 6, 7 };
+
+    const auto view = slice(list_value(a).list(), 2, 1, 4);
+    REQUIRE(view.list()->data() == a.data() + 2);  // a view, not a copy
+    REQUIRE((to_list(*view.list()) == List{ 2, 3, 4, 5 }));
+
+    const auto strided = slice(list_value(a).list(), 7, -3, 3);
+    REQUIRE(strided.list()->data() == nullptr);
+    REQUIRE((to_list(*strided.list()) == List{ 7, 4, 1 }));
+    REQUIRE(element(*strided.list(), 1) == Complex(4));
+
+    const auto doubled = apply(ElemOp::Mul, Value{ 2 }, list_value(a));
+    REQUIRE((to_list(*slice(doubled.list(), 1, 2, 3).list()) == List{ 2, 6, 10 }));
+    REQUIRE((to_list(*slice(doubled.list(), 5, 1, 3).list()) == List{ 10, 12, 14 }));
+}
+
+TEST_CASE("Fused list expressions", "[ListExpr]") {
+    List a(1000), b(1000), c(1000);
+    for (std::size_t i = 0; i < a.size(); ++i) {
+        a[i] = { i * 0.5, 1.0 };
+        b[i] = { 3.0, -(i * 0.25) };
+        c[i] = static_cast<double>(i);
+    }
+    const auto fused = apply(ElemOp::Add, apply(ElemOp::Mul, list_value(a), list_value(b)), list_value(c));
+    const auto elems = to_list(*fused.list());
+    for (std::size_t i = 0; i < a.size(); ++i)
+        REQUIRE(elems[i] == a[i] * b[i] + c[i]);
+
+    ListExprStream stream{ fused.list() };
+    REQUIRE(sum(stream) == sum(elems));
+}
@@ -0,0 +1,56 @@
+#include "catch.hpp"
+#include "NumberFormat.hpp"
+
+#include <cmath>
+#include <limits>
+#include <sstream>
+
+static std::string streamed(const Complex& n)
+{
+    std::ostringstream os;
+    print_complex(os, n);
+    return os.str();
+}
+
+static std::string formatted(const Complex& n, int precision = defaultPrecision)
+{
+    std::string s;
+    format_complex(s, n, precision);
+    return s;
+}
+
+TEST_CASE("Number formatting test", "[NumberFormat]") {
+    const double inf = std::numeric_limits<double>::infinity();
+    const List values{
+        0, -0.0, 1, -1, 42, 0.1, 1.0 / 3, 123456, 1234567, 1e-5, 1e-4, 1e100, -2.5e-300,
+        { 0, 1 }, { 0, -1 }, { 1, 1 }, { 1, -1 }, { -3, 2.5 }, { 0, 3.14159265 }, { 1e20, -1e-20 },
+        inf, -inf, { 0, inf }
+    };
+    for (const auto& n : values)
+        REQUIRE(formatted(n) == streamed(n));
+
+    std::string s;
+    format_list(s, values);
+    std::ostringstream os;
+    print_list(os, values);
+    REQUIRE(s == os.str());
+
+    REQUIRE(formatted(0.1, 0) == "0.1");
+    REQUIRE(formatted(1.0 / 3, 0) == "0.3333333333333333");
+    REQUIRE(formatted(3.14159265358979, 0) == "3.14159265358979");
+    REQUIRE(formatted({ 2, -0.5 }, 0) == "2-0.5i");
+    REQUIRE(formatted(1.0 / 3, 3) == "0.333");
+
+    std::ostringstream out;
+    {
+        OutputBuffer buf{ out, 8 };
+        buf.write(Complex{ 1, 1 });
+        buf.write('\n');
+        buf.write(List{ 1, 2 });
+        buf.write('\n');
+        buf.flush();
+        REQUIRE(out.str() == "1+i\n[1, 2]\n");
+        buf.write(Complex{ 3 });
+    }
+    REQUIRE(out.str() == "1+i\n[1, 2]\n3");
+}
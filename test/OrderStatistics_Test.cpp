@@ -0,0 +1,90 @@
+#include "catch.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+#include "ListExpr.hpp"
+#include "OrderStatistics.hpp"
+#include "Parser.hpp"
+#include "SymbolTable.hpp"
+
+TEST_CASE("Order statistics", "[OrderStatistics]") {
+    const List odd{ 7, -2, 5, 3, 11 };
+    const List even{ 4, 1, 3, 2 };
+
+    REQUIRE(list_min(odd) == Complex(-2));
+    REQUIRE(list_max(odd) == Complex(11));
+    REQUIRE(median(odd) == Complex(5));
+    REQUIRE(median(even) == Complex(2.5));
+    REQUIRE(percentile(even, 0) == Complex(1));
+    REQUIRE(percentile(even, 100) == Complex(4));
+    REQUIRE(percentile(odd, 90) == Complex(9.4));
+    REQUIRE((sorted(odd) == List{ -2, 3, 5, 7, 11 }));
+
+    const auto sortedEven = sorted(even);
+    REQUIRE(percentile({ sortedEven, true }, 25) == percentile(even, 25));
+    REQUIRE(median({ sortedEven, true }) == Complex(2.5));
+
+    REQUIRE_THROWS(median(List{}));
+    REQUIRE_THROWS(percentile(odd, 101));
+    REQUIRE_THROWS(list_max(List{ 1, { 0, 1 } }));
+    REQUIRE_THROWS(sorted(List{ { 2, 2 }, 1 }));
+    const List withNan{ 3, std::nan(""), 1, 2 };
+    REQUIRE_THROWS_WITH(median(withNan), "NaN has no order");
+    REQUIRE_THROWS_WITH(sorted(withNan), "NaN has no order");
+    REQUIRE_THROWS_WITH(list_min(withNan), "NaN has no order");
+
+    const List evens{ 2, 4, 6 };
+    const auto expr = apply(ElemOp::Sub, list_value(evens), Value{ 10 });
+    ListExprStream stream{ expr.list() };
+    REQUIRE(list_min(stream) == Complex(-8));
+    REQUIRE(median(stream) == Complex(-6));
+}
+
+TEST_CASE("Parallel sort", "[OrderStatistics]") {
+    std::mt19937_64 gen{ 7 };
+    std::uniform_real_distribution<double> dist{ -100, 100 };
+    List list(100003);
+    for (auto& c : list)
+        c = dist(gen);
+
+    auto expected = list;
+    std::sort(begin(expected), end(expected), [](const Complex& a, const Complex& b) { return a.real() < b.real(); });
+    for (unsigned threads : { 2u, 3u, 7u }) {
+        ReduceOptions opts;
+        opts.parallelThreshold = 0;
+        opts.threads = threads;
+        REQUIRE(sorted(list, opts) == expected);
+    }
+    REQUIRE(median(list) == percentile(expected, 50));
+    REQUIRE(percentile(list, 37.5) == percentile({ expected, true }, 37.5));
+}
+
+TEST_CASE("Sorted stored lists", "[OrderStatistics]") {
+    SymbolTable table;
+    Parser parser{ table };
+    Complex res;
+    parser.on_result([&res](const Complex& c) { res = c; });
+
+    parser.parse("x = [3, 1, 4, 1, 5, 9, 2, 6]");
+    REQUIRE_FALSE(table.find_list("x")->is_sorted());
+    parser.parse("s = sort(x)");
+    REQUIRE(table.find_list("s")->is_sorted());
+    REQUIRE((table.list("s") == List{ 1, 1, 2, 3, 4, 5, 6, 9 }));
+
+    parser.parse("median(x)");
+    REQUIRE(res == Complex(3.5));
+    parser.parse("percentile(s, 75)");
+    REQUIRE(res == Complex(5.25));
+    parser.parse("max(s[2:]) + min(s)");
+    REQUIRE(res == Complex(10));
+
+    parser.append("s", "0");
+    REQUIRE_FALSE(table.find_list("s")->is_sorted());
+    parser.parse("min(s)");
+    REQUIRE(res == Complex(0));
+
+    REQUIRE_THROWS(parser.parse("percentile(x)"));
+    REQUIRE_THROWS(parser.parse("sort(3)"));
+}
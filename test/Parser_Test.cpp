@@ -1,7 +1,12 @@
 #include "catch.hpp"
 
+#include <chrono>
+#include <cmath>
+#include <sstream>
+
 #include "Parser.hpp"
 #include "SymbolTable.hpp"
+#include "TokenStream.hpp"
 
 #define REQUIRE_RESULT(res) \
     REQUIRE(parser.has_result()); \
@@ -23,6 +28,10 @@ TEST_CASE("Parser Test", "[Parser]") {
 
         REQUIRE_THROWS(parser.parse("undefined(1,2,3)"));
         REQUIRE_THROWS(parser.parse("fn g(1) = 42"));
+
+        REQUIRE_NOTHROW(parser.parse("fn h(x) = x*3.14159265358979 + 1e-9"));
+        REQUIRE_PARSE_RESULT("h(1)", Complex(3.14159265358979 + 1e-9));
+        REQUIRE(parser.symbol_table().find_func("h")->get_term() == "x*3.14159265358979 + 1e-9");
     }
 
     SECTION("Expressions") {
@@ -49,6 +58,14 @@ TEST_CASE("Parser Test", "[Parser]") {
         REQUIRE(parser.result().imag() == 0);
 
         REQUIRE_PARSE_RESULT("17i - 5 * (2+3i) - (3i * i - 5 * 3 / (((i))))", Complex(-7, -13));
+
+        REQUIRE_PARSE_RESULT("2^10", Complex(1024));
+        REQUIRE_PARSE_RESULT("2^3!", Complex(64));
+        REQUIRE_PARSE_RESULT("2^2^3", Complex(256));
+        REQUIRE_PARSE_RESULT("2^2(1+1)", Complex(16));
+        REQUIRE_PARSE_RESULT("2^-1", Complex(0.5));
+        REQUIRE_PARSE_RESULT("9^0.5 + 1", Complex(4));
+        REQUIRE_PARSE_RESULT("i^2", Complex(-1));
     }
 
     SECTION("Variables") {
@@ -72,6 +89,87 @@ TEST_CASE("Parser Test", "[Parser]") {
         REQUIRE_NOTHROW(parser.parse("ux(x)"));
         REQUIRE(parser.has_result());
         REQUIRE(parser.result().real() - 0.223607 < 10e-3);
+
+        REQUIRE_NOTHROW(parser.parse("none = []"));
+        for (const auto* call : { "sum(none)", "avg(none)", "sx(none)", "ux(none)", "median(none)", "sum(none*2)",
+                                  "avg([])", "percentile(none, 50)", "sort(none)" })
+            REQUIRE_THROWS_WITH(parser.parse(call), "Invalid empty argument list");
+        REQUIRE_PARSE_RESULT("len(none)", Complex{ 0 });
+    }
+
+    SECTION("List arithmetic") {
+        REQUIRE_NOTHROW(parser.parse("a = [1, 2, 3]; b = [4, 5, 6]; c = a*b + 2a - 1"));
+        REQUIRE((parser.symbol_table().list("c") == List{ 5, 13, 23 }));
+        REQUIRE_PARSE_RESULT("sum(a*b)", Complex{ 32 });
+        REQUIRE_PARSE_RESULT("len(a, [7, 8], b)", Complex{ 8 });
+        REQUIRE_PARSE_RESULT("sum(a^2)", Complex{ 14 });
+        REQUIRE_THROWS(parser.parse("a + [1, 2]"));
+        REQUIRE_PARSE_RESULT("sum(floor(a/2) + a)", Complex{ 8 });  // built-ins map lists
+        REQUIRE_THROWS(parser.parse("sin(a) + [1, 2]"));
+        REQUIRE_THROWS(parser.parse("[for k=a, 3 k]"));
+    }
+
+    SECTION("List slices") {
+        REQUIRE_NOTHROW(parser.parse("a = [0, 1, 2, 3, 4, 5, 6, 7]"));
+        REQUIRE_PARSE_RESULT("a[2]", Complex{ 2 });
+        REQUIRE_PARSE_RESULT("a[-1]", Complex{ 7 });
+        REQUIRE_PARSE_RESULT("sum(a[2:5])", Complex{ 9 });
+        REQUIRE_PARSE_RESULT("sum(a[::3])", Complex{ 9 });
+        REQUIRE_PARSE_RESULT("len(a[5:100])", Complex{ 3 });
+        REQUIRE_PARSE_RESULT("len(a[5:2])", Complex{ 0 });
+        REQUIRE_PARSE_RESULT("sum((2a)[1:])", Complex{ 56 });
+        REQUIRE_NOTHROW(parser.parse("b = a[-2::-2]"));
+        REQUIRE((parser.symbol_table().list("b") == List{ 6, 4, 2, 0 }));
+        REQUIRE_PARSE_RESULT("sum([for k=0, 3 a[k]*a[k+1:k+2][0]])", Complex{ 20 });
+        REQUIRE_THROWS(parser.parse("a[8]"));
+        REQUIRE_THROWS(parser.parse("a[1.5]"));
+        REQUIRE_THROWS(parser.parse("a[::0]"));
+        REQUIRE_THROWS(parser.parse("x = 3; x[0]"));
+    }
+
+    SECTION("Matrices") {
+        REQUIRE_NOTHROW(parser.parse("m = [1, 2; 3, 4]"));
+        REQUIRE_FALSE(parser.has_result());
+        const auto m = parser.symbol_table().find_matrix("m");
+        REQUIRE(m);
+        REQUIRE((m->elements() == List{ 1, 2, 3, 4 }));
+        REQUIRE_PARSE_RESULT("det(m)", Complex{ -2 });
+        REQUIRE_NOTHROW(parser.parse("det(m^2 - 2m)"));
+        REQUIRE(std::abs(parser.result() - 16.0) < 1e-13);
+        REQUIRE_PARSE_RESULT("sum(m*[1, 1])", Complex{ 10 });
+        REQUIRE_PARSE_RESULT("sum(solve(m, [5, 11]))", Complex{ 3 });
+        REQUIRE_NOTHROW(parser.parse("det(inv(m)*m + eye(2))"));
+        REQUIRE(std::abs(parser.result() - 4.0) < 1e-14);
+        REQUIRE_PARSE_RESULT("det(transpose([1, 2; 3, 4;]))", Complex{ -2 });
+        REQUIRE_NOTHROW(parser.parse("r = [1, 2]; n = [r; 2r]"));
+        REQUIRE((parser.symbol_table().find_matrix("n")->elements() == List{ 1, 2, 2, 4 }));
+        REQUIRE_NOTHROW(parser.parse("m = [1, 2]"));
+        REQUIRE_FALSE(parser.symbol_table().has_matrix("m"));
+        REQUIRE_PARSE_RESULT("len([])", Complex{ 0 });
+
+        REQUIRE_THROWS(parser.parse("[1, 2; 3]"));
+        REQUIRE_THROWS(parser.parse("[;]"));
+        REQUIRE_THROWS(parser.parse("[1, 2; 3, 4] / [1, 0; 0, 1]"));
+        REQUIRE_THROWS(parser.parse("[1, 2; 3, 4]^0.5"));
+        REQUIRE_THROWS(parser.parse("sin(n)"));
+        REQUIRE_THROWS(parser.parse("inv(n)"));
+        REQUIRE_THROWS(parser.parse("[n]"));
+    }
+
+    SECTION("Lazy list ranges") {
+        REQUIRE_PARSE_RESULT("sum([for k=1, 100 k])", Complex{ 5050 });
+        REQUIRE_PARSE_RESULT("len([for k=0, 1:0.1 k])", Complex{ 11 });
+        REQUIRE_PARSE_RESULT("len([for k=10, 1:(-3) k])", Complex{ 4 });
+        REQUIRE_THROWS(parser.parse("sum([for k=1, 10:(-1) k])"));
+        REQUIRE_THROWS(parser.parse("sum([for k=1, 10 k)"));
+
+        for (const auto* reducer : { "sum", "sum2", "avg", "sx", "ux" }) {
+            const std::string reduction{ reducer };
+            REQUIRE_NOTHROW(parser.parse(reduction + "([for k=0, 200:0.7 k/7 + i])"));
+            const auto streamed = parser.result();
+            REQUIRE_NOTHROW(parser.parse("y = [for k=0, 200:0.7 k/7 + i]; " + reduction + "(y)"));
+            REQUIRE(parser.result() == streamed);
+        }
     }
 
     SECTION("Deletions") {
@@ -79,4 +177,43 @@ TEST_CASE("Parser Test", "[Parser]") {
         REQUIRE_NOTHROW(parser.parse("del a"));
         REQUIRE_FALSE(parser.symbol_table().has_var("a"));
     }
-}
\ No newline at end of file
+}
+
+TEST_CASE("Function term capture benchmark", "[.][benchmark]") {
+    using Clock = std::chrono::steady_clock;
+    std::string term;
+    for (int i = 0; i < 50; ++i)
+        term += "x*3.14159265358979 + sin(y)/2.5 - ";
+    term += "1";
+    constexpr int runs{ 20000 };
+
+    TokenStream ts;
+    std::size_t length{};
+    const auto t0 = Clock::now();
+    for (int i = 0; i < runs; ++i) {  // the previous approach: print every token back to text
+        ts.set_input(term);
+        ts.get();
+        std::ostringstream os;
+        while (ts.current().kind != Kind::End) {
+            os << ts.current();
+            ts.get();
+        }
+        length += os.str().size();
+    }
+    const auto t1 = Clock::now();
+    for (int i = 0; i < runs; ++i) {
+        ts.set_input(term);
+        ts.get();
+        ts.start_capture();
+        while (ts.current().kind != Kind::End)
+            ts.get();
+        length += ts.end_capture().size();
+    }
+    const auto t2 = Clock::now();
+
+    const std::chrono::duration<double, std::milli> reprinted = t1 - t0;
+    const std::chrono::duration<double, std::milli> captured = t2 - t1;
+    WARN("re-serialized: " << reprinted.count() << " ms, captured: " << captured.count() << " ms");
+    CHECK(length > 0);
+    CHECK(captured.count() <= reprinted.count());
+}
@@ -0,0 +1,87 @@
+#include "catch.hpp"
+
+#include "Parser.hpp"
+#include "Plugin.hpp"
+#include "SymbolTable.hpp"
+
+#define REQUIRE_PARSE_RESULT(input, res) \
+    REQUIRE_NOTHROW(parser.parse(input)); \
+    REQUIRE(parser.has_result()); \
+    REQUIRE(parser.result() == (res));
+
+TEST_CASE("Plugin functions", "[Plugin]") {
+    SymbolTable table;
+    Parser parser{ table };
+    REQUIRE(load_plugin(table, TEST_PLUGIN_PATH) == 5);
+    REQUIRE(table.is_reserved_func("model"));
+    REQUIRE(table.find_native("model")->is_pure());
+    REQUIRE_FALSE(table.find_native("tick")->is_pure());
+
+    SECTION("Numbers") {
+        REQUIRE_PARSE_RESULT("model(2, 3)", Complex(7));
+        REQUIRE_PARSE_RESULT("model(i, i)", Complex(0));
+        REQUIRE_PARSE_RESULT("sumsq(1, 2, 3, 4)", Complex(30));
+        REQUIRE_NOTHROW(parser.parse("fn f(x) = model(x, x) + 1"));
+        REQUIRE_PARSE_RESULT("f(3)", Complex(11));
+        REQUIRE(table.call_func("model", { 4, 5 }) == Complex(21));
+
+        REQUIRE_THROWS_WITH(parser.parse("model(1)"), "model expects 2 arguments (received 1)");
+        REQUIRE_THROWS_WITH(parser.parse("sumsq()"), "Invalid empty argument list");
+        REQUIRE_THROWS_WITH(parser.parse("checked(-1)"), "checked failed (error 3)");
+    }
+
+    SECTION("Lists") {
+        REQUIRE_NOTHROW(parser.parse("a = [1, 2, 3]"));
+        REQUIRE_NOTHROW(parser.parse("b = model(a, a) - 1"));
+        REQUIRE((table.list("b") == List{ 1, 4, 9 }));
+        REQUIRE_NOTHROW(parser.parse("b = model(a, 2)"));
+        REQUIRE((table.list("b") == List{ 3, 5, 7 }));
+        REQUIRE_NOTHROW(parser.parse("b = sumsq(a)"));  // mapped, not spliced like for built-ins
+        REQUIRE((table.list("b") == List{ 1, 4, 9 }));
+        REQUIRE_NOTHROW(parser.parse("b = sumsq(a, 1, a)"));
+        REQUIRE((table.list("b") == List{ 3, 9, 19 }));
+        REQUIRE_PARSE_RESULT("sum(model(a, a))", Complex(17));
+
+        REQUIRE_THROWS_WITH(parser.parse("model(a, [1, 2])"), "Lists differ in length (3 and 2)");
+        REQUIRE_THROWS_WITH(parser.parse("sum(checked(a - 2))"), "checked failed (error 3)");
+        REQUIRE_THROWS(parser.parse("model(a, [1, 2; 3, 4])"));
+    }
+
+    SECTION("Pure functions are evaluated with the list expression, in blocks") {
+        REQUIRE_NOTHROW(parser.parse("n = batches(0)"));
+        REQUIRE_NOTHROW(parser.parse("x = [for k=1, 300 k]"));
+        REQUIRE_NOTHROW(parser.parse("y = model(x, 1)"));  // lazy until assigned
+        REQUIRE_PARSE_RESULT("batches(0) - n", Complex(3));
+        REQUIRE(table.list("y")[299] == Complex(301));
+    }
+
+    SECTION("Impure functions are called once per element, in order") {
+        REQUIRE_NOTHROW(parser.parse("t = tick(0)"));
+        REQUIRE_NOTHROW(parser.parse("a = tick([0, 0, 0]) - t"));
+        REQUIRE((table.list("a") == List{ 1, 2, 3 }));
+        REQUIRE_PARSE_RESULT("tick(0) - t", Complex(4));
+    }
+
+    SECTION("Loading again replaces the functions") {
+        const auto model = table.find_native("model");
+        REQUIRE(load_plugin(table, TEST_PLUGIN_PATH) == 5);
+        REQUIRE(table.find_native("model") != model);
+        REQUIRE_PARSE_RESULT("model(2, 3)", Complex(7));  // still loaded
+    }
+}
+
+TEST_CASE("Plugin errors", "[Plugin]") {
+    SymbolTable table;
+    REQUIRE_THROWS(load_plugin(table, "no_such_plugin"));
+    REQUIRE(table.natives().empty());
+
+    Parser parser{ table };
+    parser.parse("fn model(x, y) = x + y");
+    REQUIRE_THROWS_WITH(load_plugin(table, TEST_PLUGIN_PATH), "Plugin " TEST_PLUGIN_PATH ": model is already defined");
+    REQUIRE(table.natives().empty());  // none of its functions are added
+
+    SymbolTable other;
+    REQUIRE_THROWS_WITH(load_plugin(other, OLD_TEST_PLUGIN_PATH),
+                        "Plugin " OLD_TEST_PLUGIN_PATH ": Function registered through an older plugin interface");
+    REQUIRE(other.natives().empty());
+}
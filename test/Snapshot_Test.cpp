@@ -0,0 +1,73 @@
+#include "catch.hpp"
+
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <string>
+
+#include "Parser.hpp"
+#include "Snapshot.hpp"
+#include "SymbolTable.hpp"
+
+TEST_CASE("Snapshot test", "[Snapshot]") {
+    const std::string path{ "snapshot_test.dcs" };
+
+    SymbolTable table;
+    Parser parser{ table };
+    parser.parse("a = 3.14159265358979 + 2i; x = [1, 2, 3i]; m = [1, 2i; 3, 4; 5, 6]; fn f(u, v) = u*v + a");
+    save_snapshot(table, path);
+
+    SymbolTable loaded;
+    loaded.set_var("a", 0);
+    loaded.set_var("x", 42);
+    loaded.set_matrix("a", table.find_matrix("m"));
+    loaded.set_var("m", 1);
+    REQUIRE_NOTHROW(load_snapshot(loaded, path));
+
+    REQUIRE(loaded.value_of("a") == table.value_of("a"));
+    REQUIRE(loaded.is_const("pi"));
+    REQUIRE_FALSE(loaded.has_var("x"));
+    REQUIRE(loaded.list("x") == table.list("x"));
+    REQUIRE_FALSE(loaded.has_matrix("a"));
+    REQUIRE_FALSE(loaded.has_var("m"));
+    REQUIRE(*loaded.find_matrix("m") == *table.find_matrix("m"));
+    REQUIRE(loaded.has_func("f"));
+    REQUIRE(loaded.call_func("f", { 2, 3 }) == table.call_func("f", { 2, 3 }));
+
+    {
+        std::ofstream truncated{ path, std::ios::binary | std::ios::trunc };
+        truncated << "DESKCALC";
+    }
+    REQUIRE_THROWS(load_snapshot(loaded, path));
+    REQUIRE(loaded.has_func("f"));
+
+    const auto write = [&path](const std::string& records, std::uint32_t version = 2) {
+        std::ofstream ofs{ path, std::ios::binary | std::ios::trunc };
+        const std::uint32_t header[]{ version, 0x01020304 };
+        ofs << "DESKCALC";
+        ofs.write(reinterpret_cast<const char*>(header), sizeof header);
+        ofs << records;
+    };
+    const auto u32 = [](std::uint32_t n) { return std::string(reinterpret_cast<const char*>(&n), sizeof n); };
+    const auto u64 = [](std::uint64_t n) { return std::string(reinterpret_cast<const char*>(&n), sizeof n); };
+    const auto f64 = [](double d) { return std::string(reinterpret_cast<const char*>(&d), sizeof d); };
+
+    write(u32(0xffffffff));  // a count the file cannot hold is not allocated
+    REQUIRE_THROWS_WITH(load_snapshot(loaded, path), "Snapshot is truncated or corrupt");
+    write(u32(0) + u32(0) + u32(0) + u32(1) + u32(1) + "g" + u32(0xffffffff));
+    REQUIRE_THROWS_WITH(load_snapshot(loaded, path), "Snapshot is truncated or corrupt");
+    write(u32(0) + u32(0) + u32(1) + u32(1) + "n" + u64(1) + u64(std::uint64_t{ 1 } << 62) + u32(0));
+    REQUIRE_THROWS_WITH(load_snapshot(loaded, path), "Snapshot is truncated or corrupt");
+    write(u32(1) + u32(1) + "b" + '\x07' + f64(1) + f64(0) + u32(0) + u32(0) + u32(0));  // unknown access
+    REQUIRE_THROWS_WITH(load_snapshot(loaded, path), "Snapshot is truncated or corrupt");
+    write(u32(1) + u32(1) + "b" + '\x01' + f64(1) + f64(0) + u32(0) + u32(0) + u32(0));
+    REQUIRE_NOTHROW(load_snapshot(loaded, path));
+    REQUIRE(loaded.is_const("b"));
+    write(u32(0) + u32(1) + u32(1) + "m" + u64(1) + f64(7) + f64(0) + u32(0), 1);  // no matrices before version 2
+    REQUIRE_NOTHROW(load_snapshot(loaded, path));
+    REQUIRE((loaded.list("m") == List{ 7 }));
+    REQUIRE_FALSE(loaded.has_matrix("m"));
+
+    std::remove(path.c_str());
+    REQUIRE_THROWS(load_snapshot(loaded, path));
+}
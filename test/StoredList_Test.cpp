@@ -0,0 +1,112 @@
+#include "catch.hpp"
+
+#include <cstdio>
+#include <fstream>
+
+#include "Parser.hpp"
+#include "StoredList.hpp"
+#include "SymbolTable.hpp"
+
+TEST_CASE("Mapped lists", "[StoredList]") {
+    const std::string path{ "stored_list_test.raw" };
+    const List values{ 1, { 2, -1 }, 3.5, { 0, 4 } };
+    write_raw_list(values, path);
+
+    auto mapped = StoredList::map(path);
+    REQUIRE(mapped.is_mapped());
+    REQUIRE(mapped.view() == values);
+
+    const auto shared = mapped;
+    mapped.mutable_data()[0] = 42;  // a read-only mapping is copied into memory first
+    REQUIRE_FALSE(mapped.is_mapped());
+    REQUIRE(mapped.view()[0] == Complex(42));
+    REQUIRE(shared.view() == values);
+
+    auto cow = StoredList::map(path, MapMode::CopyOnWrite);
+    cow.mutable_data()[1] = 7;
+    REQUIRE(cow.is_mapped());
+    REQUIRE(cow.view()[1] == Complex(7));
+    REQUIRE(StoredList::map(path).view() == values);
+
+    SymbolTable table;
+    Parser parser{ table };
+    table.map_list("x", path);
+    REQUIRE(table.list("x") == values);
+    Complex res;
+    parser.on_result([&res](const Complex& c) { res = c; });
+    parser.parse("sum(x)");
+    REQUIRE(res == Complex(6.5, 3));
+    parser.parse("len(x) + Re(avg(x))");
+    REQUIRE(res == Complex(4 + 6.5 / 4));
+
+    {
+        std::ofstream odd{ path, std::ios::binary | std::ios::app };
+        odd << 'x';
+    }
+    REQUIRE_THROWS(StoredList::map(path));
+    std::remove(path.c_str());
+    REQUIRE_THROWS(table.map_list("y", path));
+}
+
+TEST_CASE("Redefining and appending lists", "[StoredList]") {
+    SymbolTable table;
+    Parser parser{ table };
+
+    parser.parse("x = [for k=1, 100 k]");
+    const auto storage = table.list("x").data();
+    parser.parse("x = [for k=1, 100 -k]");
+    parser.parse("x = [for k=1, 50 2k]");  // the memory of the definition before last is reused
+    REQUIRE(table.list("x").data() == storage);
+    REQUIRE(table.list("x").size() == 50);
+    REQUIRE(table.list("x").back() == Complex(100));
+
+    REQUIRE_THROWS(parser.parse("x = 1/(x - 80)"));  // fails in the middle, x is unchanged
+    REQUIRE(table.list("x").size() == 50);
+    REQUIRE(table.list("x").back() == Complex(100));
+
+    parser.parse("x = x[::-1] + 1");  // reads itself, evaluated before it is replaced
+    REQUIRE(table.list("x").front() == Complex(101));
+    REQUIRE(table.list("x").back() == Complex(3));
+
+    parser.parse("y = [1, 2]");
+    parser.append("y", "3");
+    parser.append("y", "[4, 5]*2");
+    REQUIRE((table.list("y") == List{ 1, 2, 3, 8, 10 }));
+    parser.append("y", "y[:2]");
+    REQUIRE((table.list("y") == List{ 1, 2, 3, 8, 10, 1, 2 }));
+    REQUIRE_THROWS(parser.append("y", "1/0"));
+    REQUIRE(table.list("y").size() == 7);
+
+    parser.append("z", "[1, 2]");
+    REQUIRE((table.list("z") == List{ 1, 2 }));
+    parser.parse("v = 3");
+    REQUIRE_THROWS(parser.append("v", "1"));
+
+    const std::string path{ "stored_list_append.raw" };
+    write_raw_list(List{ 1, 2 }, path);
+    table.map_list("m", path);
+    parser.append("m", "m");
+    REQUIRE((table.list("m") == List{ 1, 2, 1, 2 }));
+    REQUIRE_FALSE(table.find_list("m")->is_mapped());
+    std::remove(path.c_str());
+}
+
+TEST_CASE("Redefining a list read by the same expression", "[StoredList]") {
+    SymbolTable table;
+    Parser parser{ table };
+    List res;
+    parser.on_list_result([&res](ListView l) { res = l.to_list(); });
+
+    parser.parse("x = [1, 2]");
+    parser.parse("x + (x = [for k=1, 1000 k])");  // the left operand keeps the old elements
+    REQUIRE((res == List{ 1, 2 }));
+    REQUIRE(table.list("x").size() == 1000);
+
+    parser.parse("x + (x = [1, 2])");
+    REQUIRE(res.size() == 1000);
+    REQUIRE(res.back() == Complex(1000));
+    REQUIRE((table.list("x") == List{ 1, 2 }));
+
+    parser.parse("x[::-1] + (x = [5, 6]) + x");
+    REQUIRE((res == List{ 7, 7 }));
+}
@@ -11,4 +11,18 @@ TEST_CASE("SymbolTable test", "[SymbolTable]") {
     REQUIRE(table.value_of("a") == Complex{ 42 });
     table.remove_var("a");
     REQUIRE_FALSE(table.has_var("a"));
+
+    REQUIRE(table.find_var("a") == nullptr);
+    REQUIRE(table.find_list("a") == nullptr);
+    REQUIRE(table.find_func("a") == nullptr);
+    REQUIRE_THROWS(table.value_of("a"));
+    REQUIRE_THROWS(table.call_func("a", { 1 }));
+    REQUIRE(table.find_builtin("sin") != nullptr);
+    REQUIRE(table.find_reduction("sum2") != nullptr);
+    REQUIRE(table.find_reduction("sin") == nullptr);
+    REQUIRE(table.find_builtin("sinus") == nullptr);
+    REQUIRE(table.find_builtin("") == nullptr);
+    REQUIRE(table.is_reserved_func("ux"));
+    REQUIRE_FALSE(table.is_reserved_func("a"));
+    REQUIRE(table.find_var("pi") != nullptr);
 }
\ No newline at end of file
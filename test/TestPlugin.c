@@ -0,0 +1,93 @@
+/* Plugin loaded by Plugin_Test.cpp, also an example of the plugin interface */
+
+#include "deskcalc_plugin.h"
+
+/* Built with a smaller size as well, to test rejecting plugins built against an older header */
+#ifndef FUNCTION_SIZE
+#define FUNCTION_SIZE sizeof(dc_function)
+#endif
+
+static int batchCalls;
+static double counter;
+
+/* model(x, y) = x y + 1 */
+static int model(const dc_complex* args, size_t nargs, dc_complex* result)
+{
+    const dc_complex x = args[0], y = args[1];
+    (void)nargs;
+    result->re = x.re * y.re - x.im * y.im + 1;
+    result->im = x.re * y.im + x.im * y.re;
+    return 0;
+}
+
+static int model_batch(const dc_complex* const* args, size_t nargs, dc_complex* results, size_t n)
+{
+    size_t i;
+    ++batchCalls;
+    for (i = 0; i < n; ++i) {
+        const dc_complex xy[2] = { args[0][i], args[1][i] };
+        model(xy, nargs, results + i);
+    }
+    return 0;
+}
+
+/* sum of squares of any number of arguments */
+static int sumsq(const dc_complex* args, size_t nargs, dc_complex* result)
+{
+    size_t i;
+    result->re = result->im = 0;
+    for (i = 0; i < nargs; ++i) {
+        result->re += args[i].re * args[i].re - args[i].im * args[i].im;
+        result->im += 2 * args[i].re * args[i].im;
+    }
+    return 0;
+}
+
+/* impure: counts its calls, adds the count to x */
+static int tick(const dc_complex* args, size_t nargs, dc_complex* result)
+{
+    (void)nargs;
+    counter += 1;
+    result->re = args[0].re + counter;
+    result->im = args[0].im;
+    return 0;
+}
+
+/* number of batch calls of model so far */
+static int batches(const dc_complex* args, size_t nargs, dc_complex* result)
+{
+    (void)args;
+    (void)nargs;
+    result->re = batchCalls;
+    result->im = 0;
+    return 0;
+}
+
+/* fails unless x is positive */
+static int checked(const dc_complex* args, size_t nargs, dc_complex* result)
+{
+    (void)nargs;
+    if (!(args[0].re > 0))
+        return 3;
+    *result = args[0];
+    return 0;
+}
+
+DESKCALC_EXPORT int deskcalc_plugin_init(const dc_host* host)
+{
+    static const dc_function functions[] = {
+        { FUNCTION_SIZE, "model", 2, 1, model, model_batch },
+        { FUNCTION_SIZE, "sumsq", DESKCALC_VARIADIC, 1, sumsq, 0 },
+        { FUNCTION_SIZE, "tick", 1, 0, tick, 0 },
+        { FUNCTION_SIZE, "batches", 1, 0, batches, 0 },
+        { FUNCTION_SIZE, "checked", 1, 1, checked, 0 },
+    };
+    size_t i;
+    if (host->abi_version != DESKCALC_PLUGIN_ABI_VERSION)
+        return 1;
+    for (i = 0; i < sizeof functions / sizeof functions[0]; ++i) {
+        if (host->register_function(host->context, &functions[i]))
+            return 2;
+    }
+    return 0;
+}
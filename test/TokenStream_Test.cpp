@@ -30,4 +30,30 @@ TEST_CASE("Lexer Test", "[Lexer]") {
     REQUIRE(ts.get().kind == Kind::FloorDiv);
     REQUIRE(ts.get().kind == Kind::Mod);
     REQUIRE(ts.get().kind == Kind::FloorDiv);
-}
\ No newline at end of file
+
+    ts.set_input("fn for del fnx form d divide mod_ _del");
+    REQUIRE(ts.get().kind == Kind::FuncDef);
+    REQUIRE(ts.get().kind == Kind::For);
+    REQUIRE(ts.get().kind == Kind::Delete);
+    for (auto ident : { "fnx", "form", "d", "divide", "mod_", "_del" }) {
+        REQUIRE(ts.get().kind == Kind::String);
+        REQUIRE(ts.current().str == ident);
+    }
+    REQUIRE(ts.get().kind == Kind::End);
+
+    ts.set_input("a + 2 * b");
+    REQUIRE(ts.peek(0).kind == Kind::End);
+    REQUIRE(ts.get().str == "a");
+    REQUIRE(ts.peek(1).kind == Kind::Plus);
+    REQUIRE(ts.peek(2).num == 2);
+    REQUIRE(ts.peek(4).str == "b");
+    REQUIRE(ts.peek(5).kind == Kind::End);
+    REQUIRE(ts.current().str == "a");
+    REQUIRE(ts.get().kind == Kind::Plus);
+    REQUIRE(ts.previous().str == "a");
+    REQUIRE(ts.get().num == 2);
+    REQUIRE(ts.get().kind == Kind::Mul);
+    REQUIRE(ts.get().str == "b");
+    REQUIRE(ts.get().kind == Kind::End);
+    REQUIRE_THROWS(ts.peek(TokenStream::capacity));
+}
@@ -0,0 +1,102 @@
+#include "catch.hpp"
+
+#include <cmath>
+#include <random>
+
+#include "linalg.hpp"
+
+static Matrix random_matrix(std::size_t rows, std::size_t cols, std::mt19937_64& gen)
+{
+    std::uniform_real_distribution<double> dist{ -1, 1 };
+    Matrix m{ rows, cols };
+    for (std::size_t i = 0; i < rows; ++i) {
+        for (std::size_t j = 0; j < cols; ++j)
+            m(i, j) = { dist(gen), dist(gen) };
+    }
+    return m;
+}
+
+static Matrix naive_multiply(const Matrix& a, const Matrix& b)
+{
+    Matrix res{ a.rows(), b.cols() };
+    for (std::size_t i = 0; i < a.rows(); ++i) {
+        for (std::size_t j = 0; j < b.cols(); ++j) {
+            Complex sum;
+            for (std::size_t k = 0; k < a.cols(); ++k)
+                sum += a(i, k) * b(k, j);
+            res(i, j) = sum;
+        }
+    }
+    return res;
+}
+
+static double max_diff(const Matrix& a, const Matrix& b)
+{
+    double diff{};
+    for (std::size_t i = 0; i < a.elements().size(); ++i)
+        diff = std::max(diff, std::abs(a.elements()[i] - b.elements()[i]));
+    return diff;
+}
+
+TEST_CASE("Matrix arithmetic", "[linalg]") {
+    Matrix a{ 2, 2 };
+    a(0, 0) = 1; a(0, 1) = 2; a(1, 0) = 3; a(1, 1) = 4;
+    Matrix b{ 2, 3 };
+    b(0, 0) = 1; b(0, 1) = 0; b(0, 2) = Complex{ 0, 1 };
+    b(1, 0) = 0; b(1, 1) = 1; b(1, 2) = 2;
+
+    const auto ab = multiply(a, b);
+    REQUIRE(ab.rows() == 2);
+    REQUIRE(ab.cols() == 3);
+    REQUIRE((ab.elements() == List{ 1, 2, Complex{ 4, 1 }, 3, 4, Complex{ 8, 3 } }));
+    REQUIRE((multiply(a, List{ 1, -1 }) == List{ -1, -1 }));
+    REQUIRE((add(a, a) == scale(a, 2)));
+    REQUIRE((sub(a, a) == Matrix{ 2, 2 }));
+    REQUIRE((transpose(b).elements() == List{ 1, 0, 0, 1, Complex{ 0, 1 }, 2 }));
+    REQUIRE((matrix_pow(a, 0) == Matrix::identity(2)));
+    REQUIRE((matrix_pow(a, 3) == multiply(multiply(a, a), a)));
+
+    REQUIRE_THROWS(multiply(b, a));
+    REQUIRE_THROWS(add(a, b));
+    REQUIRE_THROWS(multiply(a, List{ 1, 2, 3 }));
+    REQUIRE_THROWS(matrix_pow(b, 2));
+}
+
+TEST_CASE("Blocked matrix product", "[linalg]") {
+    std::mt19937_64 gen{ 5 };
+    for (const auto n : { 1, 63, 64, 65, 130 }) {  // sizes around and across the block size
+        const auto a = random_matrix(n, n + 3, gen);
+        const auto b = random_matrix(n + 3, 70, gen);
+        REQUIRE(max_diff(multiply(a, b), naive_multiply(a, b)) < 1e-12);
+    }
+}
+
+TEST_CASE("LU decomposition", "[linalg]") {
+    Matrix a{ 3, 3 };  // the first column needs a pivot swap
+    a(0, 0) = 0; a(0, 1) = 2; a(0, 2) = 1;
+    a(1, 0) = 1; a(1, 1) = 1; a(1, 2) = 0;
+    a(2, 0) = 2; a(2, 1) = 0; a(2, 2) = Complex{ 1, 1 };
+
+    const LU lu{ a };
+    REQUIRE_FALSE(lu.is_singular());
+    const auto x = lu.solve(List{ 3, 2, Complex{ 3, 1 } });
+    REQUIRE(std::abs(x[0] - 1.0) < 1e-14);
+    REQUIRE(std::abs(x[1] - 1.0) < 1e-14);
+    REQUIRE(std::abs(x[2] - 1.0) < 1e-14);
+    REQUIRE(std::abs(determinant(a) - Complex{ -4, -2 }) < 1e-14);
+    REQUIRE(max_diff(multiply(a, inverse(a)), Matrix::identity(3)) < 1e-14);
+    REQUIRE(max_diff(matrix_pow(a, -2), multiply(inverse(a), inverse(a))) < 1e-14);
+
+    std::mt19937_64 gen{ 7 };
+    const auto big = random_matrix(100, 100, gen);
+    const auto rhs = random_matrix(100, 4, gen);
+    REQUIRE(max_diff(multiply(big, LU{ big }.solve(rhs)), rhs) < 1e-10);
+
+    Matrix singular{ 2, 2 };
+    singular(0, 0) = 1; singular(0, 1) = 2; singular(1, 0) = 2; singular(1, 1) = 4;
+    REQUIRE(LU{ singular }.is_singular());
+    REQUIRE(determinant(singular) == Complex{});
+    REQUIRE_THROWS(inverse(singular));
+    REQUIRE_THROWS(determinant(Matrix{ 2, 3 }));
+    REQUIRE_THROWS(lu.solve(List{ 1, 2 }));
+}
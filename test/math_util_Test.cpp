@@ -1,6 +1,12 @@
 #include "catch.hpp"
 #include "math_util.hpp"
 
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <random>
+
 TEST_CASE("Math Utility Test", "[math_util]") {
     REQUIRE_THROWS(safe_div(1, 0));
     REQUIRE_NOTHROW(safe_div(0, { 0, 1 }));
@@ -20,7 +26,7 @@ TEST_CASE("Math Utility Test", "[math_util]") {
     REQUIRE(impedance_parallel(1000, 0) == Complex(0));
 
     REQUIRE_THROWS(factorial(-1));
-    REQUIRE_THROWS(factorial({ 0, 1 }));
+    REQUIRE_THROWS(factorial({ -2, 0 }));
 
     REQUIRE(factorial(0) == 1);
     REQUIRE(factorial(1) == 1);
@@ -28,4 +34,152 @@ TEST_CASE("Math Utility Test", "[math_util]") {
     REQUIRE(factorial(3) == 6);
     REQUIRE(factorial({ 4, 0 }) == Complex(24));
     REQUIRE(factorial({ 5, 0 }) == Complex(120));
-}
\ No newline at end of file
+    REQUIRE(factorial(20) == 2432902008176640000.0);
+    REQUIRE(factorial(170) > 7.2e306);
+    REQUIRE(factorial(171) == std::numeric_limits<double>::infinity());
+    REQUIRE(factorial({ 1000, 0 }) == Complex(std::numeric_limits<double>::infinity()));
+
+    REQUIRE(std::abs(factorial(Complex{ 0.5 }) - std::sqrt(pi) / 2) < 1e-14);
+    REQUIRE(std::abs(factorial({ 0, 1 }) - Complex(0.49801566811835604, -0.15494982830181069)) < 1e-13);
+    REQUIRE(std::abs(tgamma(Complex{ 1, 2 }) - Complex(0.15190400267003614, 0.019804880161242574)) < 1e-12);
+    const Complex z{ -1.5, 0.5 };
+    REQUIRE(std::abs(tgamma(z + 1.0) - z * tgamma(z)) < 1e-13);
+    REQUIRE(std::abs(tgamma(Complex{ 5, 1e-9 }) - Complex(24)) < 1e-6);
+
+    REQUIRE(pretty_pow({ 0, 1 }, 3) == Complex(0, -1));
+    REQUIRE(pretty_pow(-3, 3) == Complex(-27));
+    REQUIRE(pretty_pow(2, 0) == Complex(1));
+    REQUIRE(pretty_pow({ 0, 1 }, 1) == Complex(0, 1));
+    REQUIRE(pretty_pow(2, -2) == Complex(0.25));
+    REQUIRE(pretty_pow({ 1, 1 }, -1) == Complex(0.5, -0.5));
+    REQUIRE(pretty_pow(2, 1000000).real() == std::numeric_limits<double>::infinity());
+    REQUIRE(std::abs(pretty_pow(1.000001, 1000000) - std::exp(1.0)) < 1e-5);
+    REQUIRE(literal_pow(3, 2) == Complex(9));
+    REQUIRE(literal_pow(-2, 3) == Complex(-8));
+    REQUIRE(literal_pow(-4, 0.5) == Complex(0, 2));
+    REQUIRE(literal_pow(4, 1.5) == pretty_pow(4, 1.5));
+}
+
+TEST_CASE("List reductions", "[math_util]") {
+    const ReduceOptions pairwise{ Summation::Pairwise };
+    const ReduceOptions kahan{ Summation::Compensated };
+
+    const List small{ 1, { 2, 1 }, 3, { 4, -1 }, 5 };
+    for (const auto& opts : { pairwise, kahan }) {
+        REQUIRE(sum(List{}, opts) == Complex(0));
+        REQUIRE(sum(small, opts) == Complex(15));
+        REQUIRE(sqr_sum(small, opts) == Complex(53, -4));
+        REQUIRE(avg(small, opts) == Complex(3));
+        REQUIRE(std::abs(standard_deviation(List{ 2, 4, 4, 4, 5, 5, 7, 9 }, opts) - std::sqrt(32.0 / 7)) < 1e-15);
+    }
+
+    const List tenths(1000000, 0.1);
+    REQUIRE(std::abs(std::accumulate(cbegin(tenths), cend(tenths), Complex{}) - 100000.0) > 1e-7);
+    REQUIRE(std::abs(sum(tenths, pairwise) - 100000.0) < 1e-9);
+    REQUIRE(sum(tenths, kahan) == Complex(100000));
+
+    const List cancelling{ 1, 1e100, { 1, 1e100 }, { -1e100, -1e100 } };
+    REQUIRE(sum(cancelling, kahan) == Complex(2));
+}
+
+TEST_CASE("Parallel list reductions", "[math_util]") {
+    std::mt19937_64 gen{ 7 };
+    std::uniform_real_distribution<double> dist{ -1e6, 1e6 };
+    List list(300001);
+    for (auto& c : list)
+        c = { dist(gen), dist(gen) };
+
+    for (const auto summation : { Summation::Pairwise, Summation::Compensated }) {
+        ReduceOptions serial{ summation };
+        serial.parallelThreshold = std::numeric_limits<std::size_t>::max();
+        const auto expectedSum = sum(list, serial);
+        const auto expectedDev = standard_deviation(list, serial);
+
+        for (const unsigned threads : { 1u, 2u, 3u, 8u }) {
+            auto opts = serial;
+            opts.parallelThreshold = 0;
+            opts.threads = threads;
+            REQUIRE(sum(list, opts) == expectedSum);
+            REQUIRE(standard_deviation(list, opts) == expectedDev);
+        }
+    }
+}
+
+namespace {
+    class CountingStream : public ListStream {
+    public:
+        explicit CountingStream(std::size_t count) : count{ count } { }
+
+        std::size_t size() const override { return count; }
+        void restart() override { pos = 0; }
+        std::size_t read(Complex* out, std::size_t max) override
+        {
+            std::size_t n{};
+            for (; n < max && pos < count; ++n, ++pos)
+                out[n] = { pos * 0.37, 1.0 / (pos + 1) };
+            return n;
+        }
+
+    private:
+        std::size_t count;
+        std::size_t pos{};
+    };
+}
+
+TEST_CASE("Streamed list reductions", "[math_util]") {
+    CountingStream stream{ 200001 };
+    List stored(stream.size());
+    stream.read(stored.data(), stored.size());
+
+    for (const auto summation : { Summation::Pairwise, Summation::Compensated }) {
+        const ReduceOptions opts{ summation };
+        REQUIRE(len(stream) == stored.size());
+        REQUIRE(sum(stream, opts) == sum(stored, opts));
+        REQUIRE(sqr_sum(stream, opts) == sqr_sum(stored, opts));
+        REQUIRE(avg(stream, opts) == avg(stored, opts));
+        REQUIRE(standard_deviation(stream, opts) == standard_deviation(stored, opts));
+        REQUIRE(standard_uncertainty(stream, opts) == standard_uncertainty(stored, opts));
+    }
+
+    CountingStream empty{ 0 };
+    REQUIRE(sum(empty) == Complex(0));
+}
+
+TEST_CASE("List reduction benchmark", "[.][benchmark]") {
+    using Clock = std::chrono::steady_clock;
+    const auto ms = [](auto d) { return std::chrono::duration<double, std::milli>(d).count(); };
+
+    std::mt19937_64 gen{ 42 };
+    std::uniform_real_distribution<double> dist{ -1, 1 };
+    for (std::size_t n = 1000; n <= 100000000; n *= 10) {
+        List list(n);
+        for (auto& c : list)
+            c = { dist(gen), dist(gen) };
+        const auto runs = std::max<std::size_t>(1, 100000000 / n);
+
+        Complex naive, pairwise, kahan;
+        const auto t0 = Clock::now();
+        for (std::size_t r = 0; r < runs; ++r)
+            naive += std::accumulate(cbegin(list), cend(list), Complex{});
+        const auto t1 = Clock::now();
+        for (std::size_t r = 0; r < runs; ++r)
+            pairwise += sum(list, { Summation::Pairwise });
+        const auto t2 = Clock::now();
+        for (std::size_t r = 0; r < runs; ++r)
+            kahan += sum(list, { Summation::Compensated });
+        const auto t3 = Clock::now();
+        Complex parallel;
+        ReduceOptions parallelOpts;
+        parallelOpts.parallelThreshold = 0;
+        for (std::size_t r = 0; r < runs; ++r)
+            parallel += sum(list, parallelOpts);
+        const auto t4 = Clock::now();
+
+        WARN("n = " << n << ": accumulate " << ms(t1 - t0) / runs << " ms, pairwise "
+             << ms(t2 - t1) / runs << " ms, kahan " << ms(t3 - t2) / runs << " ms, parallel pairwise "
+             << ms(t4 - t3) / runs << " ms");
+        REQUIRE(std::abs(pairwise - kahan) < 1e-6 * runs);
+        REQUIRE(std::abs(naive - kahan) < 1e-6 * runs);
+        REQUIRE(parallel == pairwise);
+    }
+}
@@ -0,0 +1,143 @@
+#include "catch.hpp"
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <random>
+
+#include "Parser.hpp"
+#include "SymbolTable.hpp"
+#include "vecmath.hpp"
+
+static std::uint64_t ulps(double a, double b)
+{   // distance in representable doubles
+    if (a == b || (std::isnan(a) && std::isnan(b)))
+        return 0;
+    if (std::isnan(a) || std::isnan(b))
+        return std::numeric_limits<std::uint64_t>::max();
+    const auto ordered = [](double d) {
+        std::int64_t i;
+        std::memcpy(&i, &d, sizeof i);
+        return i < 0 ? std::numeric_limits<std::int64_t>::min() - i : i;
+    };
+    const auto ia = ordered(a);
+    const auto ib = ordered(b);
+    return ia > ib ? static_cast<std::uint64_t>(ia - ib) : static_cast<std::uint64_t>(ib - ia);
+}
+
+template<class Kernel, class Ref>
+static std::uint64_t max_ulps(Kernel kernel, Ref ref, const std::vector<double>& x)
+{
+    std::vector<double> y(x.size());
+    kernel(x.data(), y.data(), x.size());
+    std::uint64_t worst{};
+    for (std::size_t i = 0; i < x.size(); ++i)
+        worst = std::max(worst, ulps(y[i], ref(x[i])));
+    return worst;
+}
+
+static std::vector<double> uniform(double low, double high, std::size_t n, std::mt19937_64& gen)
+{
+    std::uniform_real_distribution<double> dist{ low, high };
+    std::vector<double> x(n);
+    for (auto& v : x)
+        v = dist(gen);
+    return x;
+}
+
+static std::vector<double> log_uniform(double low, double high, std::size_t n, std::mt19937_64& gen)
+{   // evenly spread over the exponents
+    auto x = uniform(std::log(low), std::log(high), n, gen);
+    for (auto& v : x)
+        v = std::exp(v);
+    return x;
+}
+
+static double sin_ref(double x) { return std::sin(x); }
+static double cos_ref(double x) { return std::cos(x); }
+static double exp_ref(double x) { return std::exp(x); }
+static double log_ref(double x) { return std::log(x); }
+
+TEST_CASE("Vectorized real kernels", "[vecmath]") {
+    std::mt19937_64 gen{ 11 };
+    constexpr std::size_t n{ 100000 };
+
+    for (const auto range : { 1e-3, 4.0, 100.0, 1e5 }) {
+        const auto x = uniform(-range, range, n, gen);
+        INFO("sin and cos on +-" << range);
+        REQUIRE(max_ulps(real_sin, sin_ref, x) <= 4);
+        REQUIRE(max_ulps(real_cos, cos_ref, x) <= 4);
+    }
+    REQUIRE(max_ulps(real_sin, sin_ref, { 0.0, -0.0, 3.141592653589793, 1e-300, 4.9e-324 }) <= 4);
+    REQUIRE(max_ulps(real_exp, exp_ref, uniform(-1, 1, n, gen)) <= 4);
+    REQUIRE(max_ulps(real_exp, exp_ref, uniform(-708, 708, n, gen)) <= 4);
+    REQUIRE(max_ulps(real_exp, exp_ref, { 0.0, 708.0, -708.0, 1e-20 }) <= 4);
+    REQUIRE(max_ulps(real_log, log_ref, uniform(0.5, 2, n, gen)) <= 4);
+    REQUIRE(max_ulps(real_log, log_ref, log_uniform(1e-307, 1e308, n, gen)) <= 4);
+    REQUIRE(max_ulps(real_log, log_ref, { 1.0, 2.2250738585072014e-308, 1.7976931348623157e308, 1 + 1e-15 }) <= 4);
+}
+
+TEST_CASE("Vectorized list functions", "[vecmath]") {
+    const auto close = [](const Complex& a, const Complex& b) {
+        return ulps(a.real(), b.real()) <= 4 && ulps(a.imag(), b.imag()) <= 4;
+    };
+    const auto inf = std::numeric_limits<double>::infinity();
+    const auto nan = std::numeric_limits<double>::quiet_NaN();
+
+    SECTION("Values outside the kernels' ranges") {
+        const List in{ -1, 0, -4, inf, -inf, nan, 1e6, 710, -750, Complex{ 0, 1e6 }, Complex{ 1e200, 1e200 },
+                       Complex{ 1e-200, 1e-200 }, Complex{ 3e-160, 3e-160 } };  // squares underflow
+        List out(in.size());
+        for (const auto& [f, ref] : { std::pair{ &vec_log, +[](const Complex& c) { return std::log(c); } },
+                                      std::pair{ &vec_sqrt, +[](const Complex& c) { return std::sqrt(c); } },
+                                      std::pair{ &vec_sin, +[](const Complex& c) { return std::sin(c); } },
+                                      std::pair{ &vec_exp, +[](const Complex& c) { return std::exp(c); } },
+                                      std::pair{ &vec_abs, +[](const Complex& c) { return Complex{ std::abs(c) }; } } }) {
+            f(in.data(), out.data(), in.size());
+            for (std::size_t i = 0; i < in.size(); ++i) {
+                INFO("element " << in[i]);
+                REQUIRE(close(out[i], ref(in[i])));
+            }
+        }
+    }
+
+    SECTION("Complex blocks") {
+        std::mt19937_64 gen{ 13 };
+        std::uniform_real_distribution<double> dist{ -50, 50 };
+        List in(1000);
+        for (auto& c : in)
+            c = { dist(gen), dist(gen) };
+        List out(in.size());
+        vec_exp(in.data(), out.data(), in.size());
+        for (std::size_t i = 0; i < in.size(); ++i)
+            REQUIRE(close(out[i], std::exp(in[i])));
+        vec_abs(in.data(), out.data(), in.size());
+        for (std::size_t i = 0; i < in.size(); ++i)
+            REQUIRE(close(out[i], std::abs(in[i])));
+
+        auto inPlace = in;
+        vec_sin(inPlace.data(), inPlace.data(), inPlace.size());
+        for (std::size_t i = 0; i < in.size(); ++i)
+            REQUIRE(inPlace[i] == std::sin(in[i]));  // complex elements go through std::sin
+    }
+
+    SECTION("Built-ins map lists") {
+        SymbolTable table;
+        Parser parser{ table };
+        REQUIRE_NOTHROW(parser.parse("x = [for k=1, 1000 k/10]; y = sqrt(x^2) - x"));
+        REQUIRE((table.list("y") == List(1000)));
+        REQUIRE_NOTHROW(parser.parse("max(abs(exp(ln(x)) - x))"));
+        REQUIRE(parser.result().real() < 1e-12);
+        REQUIRE_NOTHROW(parser.parse("z = floor([1.5, -0.5]) + CtoK([0, 0])"));
+        REQUIRE((table.list("z") == List{ 1 + 273.15, -1 + 273.15 }));
+        REQUIRE_NOTHROW(parser.parse("sqrt(-4)"));
+        const auto scalar = parser.result();
+        REQUIRE_NOTHROW(parser.parse("sqrt([-4])[0]"));
+        REQUIRE(parser.result() == scalar);
+        REQUIRE_NOTHROW(parser.parse("sin(0, [])"));  // more arguments are still spliced
+        REQUIRE(parser.result() == Complex{ 0 });
+        REQUIRE_THROWS(parser.parse("floor([1, i])"));
+        REQUIRE_THROWS(parser.parse("sin([])[0]"));
+    }
+}